@@ -0,0 +1,238 @@
+
+#include "ciphers.h"
+
+#include <QHash>
+
+#ifdef UNSAFE
+#include "sslunsafeconfiguration.h"
+#else
+#include <QSslConfiguration>
+#endif
+
+
+struct SslCipherEntry {
+    const char *name;
+    quint32 id;
+};
+
+// some ciphers are listed twice: with TLS identifier and with SSLv2 cipher spec
+
+// `openssl ciphers HIGH`
+static constexpr SslCipherEntry ciphersHigh[] = {
+    { "ECDHE-RSA-AES256-GCM-SHA384", 0xc030 },
+    { "ECDHE-ECDSA-AES256-GCM-SHA384", 0xc02c },
+    { "ECDHE-RSA-AES256-SHA384", 0xc028 },
+    { "ECDHE-ECDSA-AES256-SHA384", 0xc024 },
+    { "ECDHE-RSA-AES256-SHA", 0xc014 },
+    { "ECDHE-ECDSA-AES256-SHA", 0xc00a },
+    { "SRP-DSS-AES-256-CBC-SHA", 0xc022 },
+    { "SRP-RSA-AES-256-CBC-SHA", 0xc021 },
+    { "SRP-AES-256-CBC-SHA", 0xc020 },
+    { "DH-DSS-AES256-GCM-SHA384", 0x00a5 },
+    { "DHE-DSS-AES256-GCM-SHA384", 0x00a3 },
+    { "DH-RSA-AES256-GCM-SHA384", 0x00a1 },
+    { "DHE-RSA-AES256-GCM-SHA384", 0x009f },
+    { "DHE-RSA-AES256-SHA256", 0x006b },
+    { "DHE-DSS-AES256-SHA256", 0x006a },
+    { "DH-RSA-AES256-SHA256", 0x0069 },
+    { "DH-DSS-AES256-SHA256", 0x0068 },
+    { "DHE-RSA-AES256-SHA", 0x0039 },
+    { "DHE-DSS-AES256-SHA", 0x0038 },
+    { "DH-RSA-AES256-SHA", 0x0037 },
+    { "DH-DSS-AES256-SHA", 0x0036 },
+    { "DHE-RSA-CAMELLIA256-SHA", 0x0088 },
+    { "DHE-DSS-CAMELLIA256-SHA", 0x0087 },
+    { "DH-RSA-CAMELLIA256-SHA", 0x0086 },
+    { "DH-DSS-CAMELLIA256-SHA", 0x0085 },
+    { "AECDH-AES256-SHA", 0xc019 },
+    { "ADH-AES256-GCM-SHA384", 0x00a7 },
+    { "ADH-AES256-SHA256", 0x006d },
+    { "ADH-AES256-SHA", 0x003a },
+    { "ADH-CAMELLIA256-SHA", 0x0089 },
+    { "ECDH-RSA-AES256-GCM-SHA384", 0xc032 },
+    { "ECDH-ECDSA-AES256-GCM-SHA384", 0xc02e },
+    { "ECDH-RSA-AES256-SHA384", 0xc02a },
+    { "ECDH-ECDSA-AES256-SHA384", 0xc026 },
+    { "ECDH-RSA-AES256-SHA", 0xc00f },
+    { "ECDH-ECDSA-AES256-SHA", 0xc005 },
+    { "AES256-GCM-SHA384", 0x009d },
+    { "AES256-SHA256", 0x003d },
+    { "AES256-SHA", 0x0035 },
+    { "CAMELLIA256-SHA", 0x0084 },
+    { "PSK-AES256-CBC-SHA", 0x008d },
+    { "ECDHE-RSA-AES128-GCM-SHA256", 0xc02f },
+    { "ECDHE-ECDSA-AES128-GCM-SHA256", 0xc02b },
+    { "ECDHE-RSA-AES128-SHA256", 0xc027 },
+    { "ECDHE-ECDSA-AES128-SHA256", 0xc023 },
+    { "ECDHE-RSA-AES128-SHA", 0xc013 },
+    { "ECDHE-ECDSA-AES128-SHA", 0xc009 },
+    { "SRP-DSS-AES-128-CBC-SHA", 0xc01f },
+    { "SRP-RSA-AES-128-CBC-SHA", 0xc01e },
+    { "SRP-AES-128-CBC-SHA", 0xc01d },
+    { "DH-DSS-AES128-GCM-SHA256", 0x00a4 },
+    { "DHE-DSS-AES128-GCM-SHA256", 0x00a2 },
+    { "DH-RSA-AES128-GCM-SHA256", 0x00a0 },
+    { "DHE-RSA-AES128-GCM-SHA256", 0x009e },
+    { "DHE-RSA-AES128-SHA256", 0x0067 },
+    { "DHE-DSS-AES128-SHA256", 0x0040 },
+    { "DH-RSA-AES128-SHA256", 0x003f },
+    { "DH-DSS-AES128-SHA256", 0x003e },
+    { "DHE-RSA-AES128-SHA", 0x0033 },
+    { "DHE-DSS-AES128-SHA", 0x0032 },
+    { "DH-RSA-AES128-SHA", 0x0031 },
+    { "DH-DSS-AES128-SHA", 0x0030 },
+    { "DHE-RSA-CAMELLIA128-SHA", 0x0045 },
+    { "DHE-DSS-CAMELLIA128-SHA", 0x0044 },
+    { "DH-RSA-CAMELLIA128-SHA", 0x0043 },
+    { "DH-DSS-CAMELLIA128-SHA", 0x0042 },
+    { "AECDH-AES128-SHA", 0xc018 },
+    { "ADH-AES128-GCM-SHA256", 0x00a6 },
+    { "ADH-AES128-SHA256", 0x006c },
+    { "ADH-AES128-SHA", 0x0034 },
+    { "ADH-CAMELLIA128-SHA", 0x0046 },
+    { "ECDH-RSA-AES128-GCM-SHA256", 0xc031 },
+    { "ECDH-ECDSA-AES128-GCM-SHA256", 0xc02d },
+    { "ECDH-RSA-AES128-SHA256", 0xc029 },
+    { "ECDH-ECDSA-AES128-SHA256", 0xc025 },
+    { "ECDH-RSA-AES128-SHA", 0xc00e },
+    { "ECDH-ECDSA-AES128-SHA", 0xc004 },
+    { "AES128-GCM-SHA256", 0x009c },
+    { "AES128-SHA256", 0x003c },
+    { "AES128-SHA", 0x002f },
+    { "CAMELLIA128-SHA", 0x0041 },
+    { "PSK-AES128-CBC-SHA", 0x008c },
+};
+
+// `openssl ciphers MEDIUM`
+static constexpr SslCipherEntry ciphersMedium[] = {
+    { "DHE-RSA-SEED-SHA", 0x009a },
+    { "DHE-DSS-SEED-SHA", 0x0099 },
+    { "DH-RSA-SEED-SHA", 0x0098 },
+    { "DH-DSS-SEED-SHA", 0x0097 },
+    { "ADH-SEED-SHA", 0x009b },
+    { "SEED-SHA", 0x0096 },
+    { "IDEA-CBC-SHA", 0x0007 },
+    { "IDEA-CBC-MD5", 0x050080 },
+    { "RC2-CBC-MD5", 0x030080 },
+    { "KRB5-IDEA-CBC-SHA", 0x0021 },
+    { "KRB5-IDEA-CBC-MD5", 0x0025 },
+    { "ECDHE-RSA-RC4-SHA", 0xc011 },
+    { "ECDHE-ECDSA-RC4-SHA", 0xc007 },
+    { "AECDH-RC4-SHA", 0xc016 },
+    { "ADH-RC4-MD5", 0x0018 },
+    { "ECDH-RSA-RC4-SHA", 0xc00c },
+    { "ECDH-ECDSA-RC4-SHA", 0xc002 },
+    { "RC4-SHA", 0x0005 },
+    { "RC4-MD5", 0x0004 },
+    { "RC4-MD5", 0x010080 },
+    { "PSK-RC4-SHA", 0x008a },
+    { "KRB5-RC4-SHA", 0x0020 },
+    { "KRB5-RC4-MD5", 0x0024 },
+    { "ECDHE-RSA-DES-CBC3-SHA", 0xc012 },
+    { "ECDHE-ECDSA-DES-CBC3-SHA", 0xc008 },
+    { "SRP-DSS-3DES-EDE-CBC-SHA", 0xc01c },
+    { "SRP-RSA-3DES-EDE-CBC-SHA", 0xc01b },
+    { "SRP-3DES-EDE-CBC-SHA", 0xc01a },
+    { "EDH-RSA-DES-CBC3-SHA", 0x0016 },
+    { "EDH-DSS-DES-CBC3-SHA", 0x0013 },
+    { "DH-RSA-DES-CBC3-SHA", 0x0010 },
+    { "DH-DSS-DES-CBC3-SHA", 0x000d },
+    { "AECDH-DES-CBC3-SHA", 0xc017 },
+    { "ADH-DES-CBC3-SHA", 0x001b },
+    { "ECDH-RSA-DES-CBC3-SHA", 0xc00d },
+    { "ECDH-ECDSA-DES-CBC3-SHA", 0xc003 },
+    { "DES-CBC3-SHA", 0x000a },
+    { "DES-CBC3-MD5", 0x0700c0 },
+    { "PSK-3DES-EDE-CBC-SHA", 0x008b },
+    { "KRB5-DES-CBC3-SHA", 0x001f },
+    { "KRB5-DES-CBC3-MD5", 0x0023 },
+};
+
+// `openssl ciphers LOW`
+static constexpr SslCipherEntry ciphersLow[] = {
+    { "EDH-RSA-DES-CBC-SHA", 0x0015 },
+    { "EDH-DSS-DES-CBC-SHA", 0x0012 },
+    { "DH-RSA-DES-CBC-SHA", 0x000f },
+    { "DH-DSS-DES-CBC-SHA", 0x000c },
+    { "ADH-DES-CBC-SHA", 0x001a },
+    { "DES-CBC-SHA", 0x0009 },
+};
+
+// `openssl ciphers EXPORT`
+static constexpr SslCipherEntry ciphersExport[] = {
+    { "EXP-EDH-RSA-DES-CBC-SHA", 0x0014 },
+    { "EXP-EDH-DSS-DES-CBC-SHA", 0x0011 },
+    { "EXP-ADH-DES-CBC-SHA", 0x0019 },
+    { "EXP-DES-CBC-SHA", 0x0008 },
+    { "EXP-RC2-CBC-MD5", 0x0006 },
+    { "EXP-RC2-CBC-MD5", 0x040080 },
+    { "EXP-ADH-RC4-MD5", 0x0017 },
+    { "EXP-RC4-MD5", 0x0003 },
+    { "EXP-RC4-MD5", 0x020080 },
+};
+
+struct SslCipherTable {
+    const SslCipherEntry *entries;
+    int size;
+};
+
+template <int N>
+static constexpr SslCipherTable cipherTable(const SslCipherEntry (&entries)[N])
+{
+    return { entries, N };
+}
+
+static constexpr SslCipherTable cipherTables[SslCipherGradesCount] = {
+    cipherTable(ciphersHigh),
+    cipherTable(ciphersMedium),
+    cipherTable(ciphersLow),
+    cipherTable(ciphersExport),
+};
+
+// the tables matched against ciphers of the loaded library
+class SslCipherGrades
+{
+public:
+    SslCipherGrades()
+    {
+        QHash<QString, XSslCipher> supported;
+        const QList<XSslCipher> supportedCiphers = XSslConfiguration::supportedCiphers();
+        for (const XSslCipher &cipher : supportedCiphers) {
+            supported.insert(cipher.name(), cipher);
+        }
+
+        for (int grade = 0; grade < SslCipherGradesCount; grade++) {
+            const SslCipherTable &table = cipherTables[grade];
+
+            ids[grade].reserve(table.size);
+            for (int i = 0; i < table.size; i++) {
+                ids[grade] << table.entries[i].id;
+
+                XSslCipher cipher = supported.value(QLatin1String(table.entries[i].name));
+                if (!cipher.isNull() && !ciphers[grade].contains(cipher))
+                    ciphers[grade] << cipher;
+            }
+        }
+    }
+
+    QList<XSslCipher> ciphers[SslCipherGradesCount];
+    QVector<quint32> ids[SslCipherGradesCount];
+
+};
+
+// thread-safe, tests are prepared in parallel
+static const SslCipherGrades &cipherGrades()
+{
+    static const SslCipherGrades grades;
+    return grades;
+}
+
+const QList<XSslCipher> &sslCiphersOfGrade(SslCipherGrade grade)
+{
+    return cipherGrades().ciphers[grade];
+}
+
+const QVector<quint32> &sslCipherIdsOfGrade(SslCipherGrade grade)
+{
+    return cipherGrades().ids[grade];
+}
@@ -5,34 +5,43 @@
 
 #include <QDebug>
 
-#define DEBUG(msg) \
-( \
-    (fprintf(stdout, "%s\n", QString(msg).toLocal8Bit().constData())), \
-    (void)0 \
-)
+#include "ssllog.h"
 
-#define VERBOSE(msg) \
-( \
-    (fprintf(stdout, "%s\n", QString(msg).toLocal8Bit().constData())), \
-    (void)0 \
-)
+// Messages below this level are compiled out, e.g. -DQSSLCAUDIT_LOG_LEVEL=1
+// drops DEBUG() calls. Values are those of SslLog::Level.
+#ifndef QSSLCAUDIT_LOG_LEVEL
+#define QSSLCAUDIT_LOG_LEVEL 0
+#endif
 
-#define WHITE(msg) \
+// the message expression is only evaluated if its level is enabled at runtime,
+// its conversion and output happen on the writer thread of SslLog
+#define SSLLOG(level, color, msg) \
 ( \
-    (fprintf(stdout, "\033[1m%s\033[0m\n", QString(msg).toLocal8Bit().constData())), \
-    (void)0 \
+    SslLog::isEnabled(level) ? SslLog::write(color, QString(msg)) : (void)0 \
 )
 
-#define GREEN(msg) \
-( \
-    (fprintf(stdout, "\033[1;32m%s\033[0m\n", QString(msg).toLocal8Bit().constData())), \
-    (void)0 \
-)
-
-#define RED(msg) \
-( \
-    (fprintf(stdout, "\033[1;31m%s\033[0m\n", QString(msg).toLocal8Bit().constData())), \
-    (void)0 \
-)
+#if QSSLCAUDIT_LOG_LEVEL <= 0
+#define DEBUG(msg) SSLLOG(SslLog::Debug, SslLog::Plain, msg)
+#else
+#define DEBUG(msg) ((void)0)
+#endif
+
+#if QSSLCAUDIT_LOG_LEVEL <= 1
+#define VERBOSE(msg) SSLLOG(SslLog::Verbose, SslLog::Plain, msg)
+#else
+#define VERBOSE(msg) ((void)0)
+#endif
+
+#if QSSLCAUDIT_LOG_LEVEL <= 2
+#define INFO(msg) SSLLOG(SslLog::Info, SslLog::Plain, msg)
+#define WHITE(msg) SSLLOG(SslLog::Info, SslLog::Bold, msg)
+#define GREEN(msg) SSLLOG(SslLog::Info, SslLog::BoldGreen, msg)
+#else
+#define INFO(msg) ((void)0)
+#define WHITE(msg) ((void)0)
+#define GREEN(msg) ((void)0)
+#endif
+
+#define RED(msg) SSLLOG(SslLog::Error, SslLog::BoldRed, msg)
 
 #endif // DEBUG_H
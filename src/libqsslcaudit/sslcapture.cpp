@@ -0,0 +1,106 @@
+#include "sslcapture.h"
+#include "debug.h"
+
+#include <QDir>
+#include <QTemporaryFile>
+
+
+qint64 SslCapture::captureMemoryLimit = 4096;
+QString SslCapture::captureSpillDirectory;
+
+SslCapture::SslCapture()
+{
+    clear();
+}
+
+void SslCapture::setMemoryLimit(qint64 limit)
+{
+    captureMemoryLimit = limit;
+}
+
+qint64 SslCapture::memoryLimit()
+{
+    return captureMemoryLimit;
+}
+
+void SslCapture::setSpillDirectory(const QString &path)
+{
+    if (!QDir().mkpath(path)) {
+        RED("can not create capture directory " + path);
+        return;
+    }
+
+    captureSpillDirectory = path;
+}
+
+QString SslCapture::spillDirectory()
+{
+    return captureSpillDirectory;
+}
+
+QString SslCapture::spillPath() const
+{
+    if (!m_spillFile)
+        return QString();
+    return m_spillFile->fileName();
+}
+
+void SslCapture::clear()
+{
+    m_size = 0;
+    m_droppedSize = 0;
+    m_prefix.clear();
+    // the file itself is kept, it belongs to the user now
+    m_spillFile.clear();
+}
+
+bool SslCapture::openSpillFile()
+{
+    if (captureSpillDirectory.isEmpty())
+        return false;
+
+    QTemporaryFile *file = new QTemporaryFile(QDir(captureSpillDirectory).filePath("capture-XXXXXX.bin"));
+    file->setAutoRemove(false);
+
+    if (!file->open()) {
+        RED("can not create capture file in " + captureSpillDirectory);
+        delete file;
+        return false;
+    }
+
+    m_spillFile = QSharedPointer<QFile>(file);
+    // the file holds the whole stream
+    m_spillFile->write(m_prefix);
+
+    VERBOSE("intercepted data exceeds memory limit, saving it to " + m_spillFile->fileName());
+
+    return true;
+}
+
+void SslCapture::append(const QByteArray &data)
+{
+    if (data.isEmpty())
+        return;
+
+    m_size += data.size();
+
+    int kept = qMin<qint64>(data.size(), captureMemoryLimit - m_prefix.size());
+    if (kept > 0)
+        m_prefix.append(data.constData(), kept);
+
+    if (!m_spillFile && (m_size > captureMemoryLimit)) {
+        if (!openSpillFile()) {
+            m_droppedSize += data.size() - kept;
+            return;
+        }
+        // the part kept in memory is already written
+        if (m_spillFile->write(data.mid(kept)) != data.size() - kept)
+            m_droppedSize += data.size() - kept;
+        return;
+    }
+
+    if (m_spillFile) {
+        if (m_spillFile->write(data) != data.size())
+            m_droppedSize += data.size();
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef SSLCAPTURE_H
+#define SSLCAPTURE_H
+
+#include <QByteArray>
+#include <QString>
+#include <QSharedPointer>
+#include <QFile>
+
+
+// Storage for data intercepted from a client.
+// Only the first memoryLimit() bytes are kept in memory, this is what reports
+// and verdicts use. Once a connection sends more, all its data is streamed
+// into a file in spillDirectory(), or the rest is only counted if there is no
+// such directory.
+class SslCapture
+{
+public:
+    SslCapture();
+
+    void append(const QByteArray &data);
+    void clear();
+
+    bool isEmpty() const { return m_size == 0; }
+    qint64 size() const { return m_size; }
+    qint64 droppedSize() const { return m_droppedSize; }
+    const QByteArray &prefix() const { return m_prefix; }
+    QString spillPath() const;
+
+    static void setMemoryLimit(qint64 limit);
+    static qint64 memoryLimit();
+
+    static void setSpillDirectory(const QString &path);
+    static QString spillDirectory();
+
+private:
+    bool openSpillFile();
+
+    qint64 m_size;
+    qint64 m_droppedSize;
+    QByteArray m_prefix;
+    QSharedPointer<QFile> m_spillFile;
+
+    static qint64 captureMemoryLimit;
+    static QString captureSpillDirectory;
+
+};
+
+#endif // SSLCAPTURE_H
@@ -1,11 +1,20 @@
 
 #include "sslcaudit.h"
 #include "sslserver.h"
+#include "sslrelay.h"
+#include "sslresultcache.h"
+#include "sslresultstream.h"
+#include "sslcipherbisector.h"
+#include "sslstartupprofile.h"
+#include "ssltranscript.h"
+#include "ssltests.h"
 #include "debug.h"
 
 #include <QCoreApplication>
 #include <QThread>
 #include <QFile>
+#include <QTimer>
+#include <QEventLoop>
 
 #ifdef UNSAFE
 #include "sslunsafesocket.h"
@@ -19,9 +28,21 @@
 SslCAudit::SslCAudit(const SslUserSettings settings, QObject *parent) :
     QObject(parent),
     settings(settings),
-    sslTests(QList<SslTest *>())
+    sslTests(QList<SslTest *>()),
+    currentTest(nullptr),
+    currentServer(nullptr),
+    round(new SslTestRound),
+    following(false),
+    enumerationConnections(-1)
 {
-    VERBOSE("SSL library used: " + XSslSocket::sslLibraryVersionString());
+    connect(round.data(), &SslTestRound::acceptingFinished, this, &SslCAudit::handleAcceptingFinished);
+}
+
+SslCAudit::~SslCAudit()
+{
+    foreach (const QList<SslTest *> &tests, clientsTests) {
+        qDeleteAll(tests);
+    }
 }
 
 void SslCAudit::showCiphers()
@@ -43,12 +64,87 @@ void SslCAudit::setSslTests(const QList<SslTest *> &tests)
     sslTests = tests;
 }
 
-SslServer *SslCAudit::prepareSslServer(const SslTest *test)
+void SslCAudit::addWorker(SslCAudit *worker)
+{
+    // the worker hands results of its connections over to this instance
+    worker->round = round;
+    worker->following = true;
+    round->setWorkersCount(round->workersCount() + 1);
+
+    connect(round.data(), &SslTestRound::started, worker, &SslCAudit::handleRoundStarted);
+    connect(round.data(), &SslTestRound::acceptingFinished, worker, &SslCAudit::handleAcceptingFinished);
+    connect(this, &SslCAudit::sslTestsFinished, worker, &SslCAudit::stopWorker);
+}
+
+SslServer *SslCAudit::prepareSslServer()
 {
     QHostAddress listenAddress = settings.getListenAddress();
     quint16 listenPort = settings.getListenPort();
     SslServer *sslServer = new SslServer;
+    int workers = round->workersCount();
+
+    sslServer->setStartTlsProto(settings.getStartTlsProtocol());
+
+    bool listening = (workers > 1) ? sslServer->listenShared(listenAddress, listenPort)
+                                   : sslServer->listen(listenAddress, listenPort);
+    if (!listening) {
+        RED(QString("can not bind to %1:%2").arg(listenAddress.toString()).arg(listenPort));
+        sslServer->deleteLater();
+        return nullptr;
+    }
+
+    // do not accept anything until the first test is configured
+    sslServer->pauseAccepting();
+
+    connect(sslServer, &SslServer::newConnection, this, &SslCAudit::handleNewConnection);
+    connect(sslServer, &SslServer::acceptError, this, &SslCAudit::handleAcceptError);
+    connect(sslServer, &SslServer::clientHelloReceived, this, &SslCAudit::handleClientHello);
+    connect(sslServer, &SslServer::sslInitFailed, this, &SslCAudit::handleSslInitFailure);
+
+    if (workers > 1) {
+        if (!following)
+            VERBOSE(QString("listening on %1:%2 with %3 workers").arg(listenAddress.toString()).arg(listenPort).arg(workers));
+    } else {
+        VERBOSE(QString("listening on %1:%2").arg(listenAddress.toString()).arg(listenPort));
+    }
+    return sslServer;
+}
 
+// supported curves with the one of an EC private key in the first place
+static QVector<XSslEllipticCurve> ellipticCurvesForKey(const XSslKey &key)
+{
+    QVector<XSslEllipticCurve> curves = XSslConfiguration::supportedEllipticCurves();
+
+    if (key.algorithm() != XSsl::Ec)
+        return curves;
+
+    XSslEllipticCurve keyCurve;
+    switch (key.length()) {
+    case 256:
+        keyCurve = XSslEllipticCurve::fromShortName("prime256v1");
+        break;
+    case 384:
+        keyCurve = XSslEllipticCurve::fromShortName("secp384r1");
+        break;
+    case 521:
+        keyCurve = XSslEllipticCurve::fromShortName("secp521r1");
+        break;
+    default:
+        return curves;
+    }
+
+    if (keyCurve.isValid()) {
+        curves.removeAll(keyCurve);
+        curves.prepend(keyCurve);
+    }
+
+    return curves;
+}
+
+void SslCAudit::configureSslServer(SslServer *sslServer, const SslTest *test)
+{
+    // the listening socket is kept between tests, only SSL parameters are swapped
+    // (they are applied to each connection in SslServer::incomingConnection)
     sslServer->setSslLocalCertificateChain(test->localCert());
 
     sslServer->setSslPrivateKey(test->privateKey());
@@ -57,155 +153,509 @@ SslServer *SslCAudit::prepareSslServer(const SslTest *test)
 
     sslServer->setSslCiphers(test->sslCiphers());
 
-    sslServer->setStartTlsProto(settings.getStartTlsProtocol());
+    sslServer->setSslEllipticCurves(ellipticCurvesForKey(test->privateKey()));
+}
 
-    if (!sslServer->listen(listenAddress, listenPort)) {
-        RED(QString("can not bind to %1:%2").arg(listenAddress.toString()).arg(listenPort));
-        sslServer->deleteLater();
-        return nullptr;
+void SslCAudit::handleIncomingConnection(XSslSocket *sslSocket, SslTest *test)
+{
+    // the ClientHello is received, the handshake starts
+    test->markPhase(SslPhaseTimings::Accept);
+
+    if (!settings.getForwardHostAddr().isNull()) {
+        // the relay lives until either side closes the connection, no matter how long it is idle
+        delete waitDataTimers.take(sslSocket);
+
+        SslRelay *relay = new SslRelay(sslSocket, settings.getForwardHostAddr(),
+                                       settings.getForwardHostPort(), sslSocket);
+        connect(relay, &SslRelay::dataIntercepted, this, [=](const QByteArray &data) {
+            if (connectionTests.contains(sslSocket))
+                test->addInterceptedData(data);
+        });
+        connect(relay, &SslRelay::finished, this, [=]() {
+            finishConnectionLater(sslSocket);
+        });
+        relay->start();
+        return;
     }
 
-    VERBOSE(QString("listening on %1:%2").arg(listenAddress.toString()).arg(listenPort));
-    return sslServer;
+    // handling socket errors makes sence only in non-interception mode
+
+    connect(sslSocket, static_cast<void(XSslSocket::*)(QAbstractSocket::SocketError)>(&XSslSocket::error),
+            this, &SslCAudit::handleSocketError);
+    connect(sslSocket, &XSslSocket::encrypted, this, &SslCAudit::sslHandshakeFinished);
+    connect(sslSocket, static_cast<void(XSslSocket::*)(const QList<XSslError> &)>(&XSslSocket::sslErrors),
+            this, &SslCAudit::handleSslErrors);
+    connect(sslSocket, &XSslSocket::peerVerifyError, this, &SslCAudit::handlePeerVerifyError);
+
+    // no 'forward' option -- just read the first packet of unencrypted data and close the connection
+    connect(sslSocket, &XSslSocket::readyRead, this, &SslCAudit::handleSocketReadyRead);
+    connect(sslSocket, &XSslSocket::disconnected, this, &SslCAudit::handleSocketDisconnected);
 }
 
-void SslCAudit::proxyConnection(XSslSocket *sslSocket, SslTest *test)
+void SslCAudit::finishConnection(XSslSocket *sslSocket, SslTest *test)
 {
-    // in case 'forward' option was set, we do the following:
-    // - connect to the proxy;
-    // - synchronously read data from ssl socket
-    // - synchronously send this data to proxy
-    QTcpSocket proxy;
+    // be sure that socket is disconnected
+    sslSocket->close();
+    sslSocket->deleteLater();
 
-    proxy.connectToHost(settings.getForwardHostAddr(), settings.getForwardHostPort());
+    test->calcResults();
 
-    if (!proxy.waitForConnected(2000)) {
-        RED("can't connect to the forward proxy");
+    if (perConnectionTests()) {
+        WHITE(QString("report for %1:").arg(test->clientAddress()));
     } else {
-        WHITE("forwarding incoming data to the provided proxy");
-        WHITE("to get test results, relauch this app without 'forward' option");
+        WHITE("report:");
+    }
 
-        while (1) {
-            if (sslSocket->state() == QAbstractSocket::UnconnectedState)
-                break;
-            if (proxy.state() == QAbstractSocket::UnconnectedState)
-                break;
+    test->printReport();
+    VERBOSE(QString("verdict reached in %1 ms").arg(test->verdictTime()));
+    VERBOSE(QString("phases (ms): %1").arg(test->phaseTimings().toString()));
 
-            if (sslSocket->waitForReadyRead(100)) {
-                QByteArray data = sslSocket->readAll();
+#ifdef UNSAFE
+    // the transcript is recorded for every connection, but only decoded here
+    if (SslTranscript::isEnabled() && test->isUnexpectedResult()) {
+        QString path = SslTranscript::save(test, sslSocket->handshakeTranscript());
+        if (!path.isEmpty())
+            VERBOSE("unexpected outcome, handshake transcript saved to " + path);
+    }
+#endif
 
-                test->addInterceptedData(data);
+    // the test context of a worker is not used by it anymore
+    round->finishClient(following ? test : nullptr);
+}
 
-                proxy.write(data);
-            }
+// the socket can still be in use by the code emitting the signal being handled,
+// thus it is closed once control returns to the event loop
+void SslCAudit::finishConnectionLater(XSslSocket *sslSocket)
+{
+    // the outcome is known, the connection is ignored by handlers of signals emitted meanwhile
+    SslTest *test = connectionTests.take(sslSocket);
+    if (!test)
+        return;
 
-            if (proxy.waitForReadyRead(100)) {
-                sslSocket->write(proxy.readAll());
-            }
-        }
+    test->markPhase(SslPhaseTimings::Disconnect);
+    test->setVerdictTime(connectionTimers.take(sslSocket).elapsed());
+    // the timer is a child of the socket
+    waitDataTimers.remove(sslSocket);
+
+    sslSocket->disconnect(this);
+
+    QTimer::singleShot(0, this, [=]() {
+        finishConnection(sslSocket, test);
+    });
+}
+
+SslTest *SslCAudit::socketTest(QObject *socket) const
+{
+    return connectionTests.value(socket);
+}
+
+bool SslCAudit::perConnectionTests() const
+{
+    return (settings.getClientsCount() > 1) || (round->workersCount() > 1);
+}
+
+void SslCAudit::handleNewConnection()
+{
+    XSslSocket *sslSocket = dynamic_cast<XSslSocket*>(currentServer->nextPendingConnection());
+    if (!sslSocket)
+        return;
+
+    if (!round->addClient()) {
+        VERBOSE("connection accepted in between tests, closing it");
+        sslSocket->close();
+        sslSocket->deleteLater();
+        return;
+    }
+
+    // several clients can be audited at once, each of them gets its own copy of the test
+    SslTest *test = round->test();
+    if (perConnectionTests()) {
+        test = test->clone();
+        // copies owned by workers are collected once the test is finished
+        if (!following)
+            clientsTests[test->id()] << test;
     }
+    test->setClientAddress(QString("%1:%2").arg(sslSocket->peerAddress().toString()).arg(sslSocket->peerPort()));
+    VERBOSE("connection from: " + test->clientAddress());
+    connectionTests.insert(sslSocket, test);
+    connectionTimers[sslSocket].start();
+    // the server measured the connection since it was accepted
+    test->setPhaseTimings(currentServer->takePhaseTimings(sslSocket));
+
+    // covers silent clients too: the connection is handled further once its ClientHello is received
+    QTimer *waitDataTimer = new QTimer(sslSocket);
+    waitDataTimer->setSingleShot(true);
+    connect(waitDataTimer, &QTimer::timeout, this, [=]() {
+        if (!connectionTests.contains(sslSocket))
+            return;
+        VERBOSE(QString("no data received (timeout of %1 ms expired)").arg(settings.getWaitDataTimeout()));
+        finishConnectionLater(sslSocket);
+    });
+    waitDataTimer->start(settings.getWaitDataTimeout());
+    waitDataTimers.insert(sslSocket, waitDataTimer);
 }
 
-void SslCAudit::handleIncomingConnection(XSslSocket *sslSocket, SslTest *test)
+void SslCAudit::handleClientHello(XSslSocket *sslSocket, const SslClientHello &hello)
 {
-    VERBOSE(QString("connection from: %1:%2").arg(sslSocket->peerAddress().toString()).arg(sslSocket->peerPort()));
+    SslTest *test = socketTest(sslSocket);
+    if (!test)
+        return;
 
-    if (!settings.getForwardHostAddr().isNull()) {
-        // this will loop until connection is interrupted
-        proxyConnection(sslSocket, test);
-    } else {
-        // handling socket errors makes sence only in non-interception mode
+    if (hello.isValid()) {
+        VERBOSE(hello.description());
+        currentClientHellos << hello;
+    }
+    test->setClientHello(hello);
 
-        connect(sslSocket, static_cast<void(XSslSocket::*)(QAbstractSocket::SocketError)>(&XSslSocket::error),
-                this, &SslCAudit::handleSocketError);
-        connect(sslSocket, &XSslSocket::encrypted, this, &SslCAudit::sslHandshakeFinished);
-        connect(sslSocket, static_cast<void(XSslSocket::*)(const QList<XSslError> &)>(&XSslSocket::sslErrors),
-                this, &SslCAudit::handleSslErrors);
-        connect(sslSocket, &XSslSocket::peerVerifyError, this, &SslCAudit::handlePeerVerifyError);
+    if (sslSocket->state() != QAbstractSocket::ConnectedState) {
+        VERBOSE("no data received (" + sslSocket->errorString() + ")");
+        finishConnectionLater(sslSocket);
+        return;
+    }
 
-        // no 'forward' option -- just read the first packet of unencrypted data and close the connection
-        if (sslSocket->waitForReadyRead(settings.getWaitDataTimeout())) {
-            QByteArray message = sslSocket->readAll();
+    // now we can hanle client side
+    handleIncomingConnection(sslSocket, test);
+}
 
-            VERBOSE("received data: " + QString(message));
+void SslCAudit::handleSslInitFailure(XSslSocket *sslSocket)
+{
+    SslTest *test = socketTest(sslSocket);
+    if (!test)
+        return;
 
-            test->addInterceptedData(message);
+    // check if *server* was not able to setup SSL connection
+    QStringList sslInitErrors = currentServer->getSslInitErrorsStr();
 
-            sslSocket->disconnectFromHost();
-            sslSocket->waitForDisconnected();
-            VERBOSE("disconnected");
-        } else {
-            VERBOSE("no data received (" + sslSocket->errorString() + ")");
-        }
+    RED("failure during SSL initialization, test will not continue");
+
+    for (int i = 0; i < sslInitErrors.size(); i++) {
+        VERBOSE("\t" + sslInitErrors.at(i));
     }
+
+    test->addSocketErrors(currentServer->getSslInitErrors());
+    finishConnectionLater(sslSocket);
 }
 
-void SslCAudit::runTest(SslTest *test)
+void SslCAudit::handleAcceptError(QAbstractSocket::SocketError socketError)
 {
-    SslServer *sslServer;
+    Q_UNUSED(socketError);
 
-    WHITE(QString("running test #%1: %2").arg(test->id()).arg(test->description()));
+    VERBOSE("could not establish encrypted connection (" + currentServer->errorString() + ")");
+
+    // do not wait for more clients, complete the test once the accepted ones are handled
+    round->stopAccepting();
+}
 
-    sslServer = prepareSslServer(test);
-    if (!sslServer) {
+void SslCAudit::handleRoundStarted()
+{
+    if (!currentServer)
         return;
+
+    currentClientHellos.clear();
+    configureSslServer(currentServer, round->test());
+    currentServer->resumeAccepting();
+}
+
+void SslCAudit::handleAcceptingFinished()
+{
+    // clients connecting in between tests wait in the listen backlog
+    if (currentServer)
+        currentServer->pauseAccepting();
+
+    round->workerPaused();
+}
+
+void SslCAudit::stopWorker()
+{
+    if (currentServer) {
+        currentServer->close();
+        currentServer->deleteLater();
+        currentServer = nullptr;
     }
 
+    this->deleteLater();
+    QThread::currentThread()->quit();
+}
+
+void SslCAudit::runTest(SslTest *test)
+{
+    WHITE(QString("running test #%1: %2").arg(test->id()).arg(test->description()));
+
+    configureSslServer(currentServer, test);
+
+    qDeleteAll(clientsTests.take(test->id()));
+    currentClientHellos.clear();
+
+    // connections are handled asynchronously until all expected clients are done,
+    // the round may be finished by a worker before the loop is entered
+    QEventLoop loop;
+    connect(round.data(), &SslTestRound::finished, &loop, &QEventLoop::quit);
+
+    // workers resume accepting as well
+    round->start(test, settings.getClientsCount());
+    currentServer->resumeAccepting();
+
     emit sslTestReady();
 
-    if (sslServer->waitForNewConnection(-1)) {
-        // check if *server* was not able to setup SSL connection
-        QStringList sslInitErrors = sslServer->getSslInitErrorsStr();
+    loop.exec();
 
-        if (sslInitErrors.size() > 0) {
-            RED("failure during SSL initialization, test will not continue");
+    // the server is paused already (see handleAcceptingFinished())
 
-            for (int i = 0; i < sslInitErrors.size(); i++) {
-                VERBOSE("\t" + sslInitErrors.at(i));
-            }
+    const QList<SslTest *> workersResults = round->takeResults();
+    for (int i = 0; i < workersResults.size(); i++) {
+        clientsTests[test->id()] << workersResults.at(i);
+        if (workersResults.at(i)->clientHello().isValid())
+            currentClientHellos << workersResults.at(i)->clientHello();
+    }
 
-            test->addSocketErrors(sslServer->getSslInitErrors());
-            test->calcResults();
+    if (!currentClientHellos.isEmpty())
+        knownClientHellos = currentClientHellos;
 
-            sslServer->close();
-            sslServer->deleteLater();
-            return;
-        }
+    const QList<SslTest *> roundTests = clientsTests.contains(test->id()) ?
+                clientsTests.value(test->id()) : QList<SslTest *>() << test;
+    for (int i = 0; i < roundTests.size(); i++) {
+        if (roundTests.at(i)->phaseTimings().isStarted())
+            phaseStats[test->id()].add(roundTests.at(i)->phaseTimings());
+    }
 
-        // now we can hanle client side
-        XSslSocket *sslSocket = dynamic_cast<XSslSocket*>(sslServer->nextPendingConnection());
-        // this call will loop until connection close if 'forward' option is set
-        handleIncomingConnection(sslSocket, test);
-        // be sure that socket is disconnected
-        sslSocket->close();
-        sslSocket->deleteLater();
+    WHITE("test finished");
+}
+
+bool SslCAudit::inferResult(SslTest *test)
+{
+    int implyingTest = settings.getAdaptiveTests() ? planner.implyingTest(test) : 0;
+    if (implyingTest != 0) {
+        setInferredResult(test, SslTest::SSLTEST_RESULT_SUCCESS,
+                          QString("test passed (inferred), implied by the result of test #%1").arg(implyingTest));
+        return true;
+    }
+
+    if (settings.getInferFromClientHello() && inferFromClientHellos(test))
+        return true;
+
+    // the same client build was already audited
+    if (SslResultCache::isEnabled() && inferFromResultCache(test))
+        return true;
+
+    return false;
+}
+
+bool SslCAudit::inferFromClientHellos(SslTest *test)
+{
+    // every client audited by the previous test has to be excluded
+    if (knownClientHellos.isEmpty())
+        return false;
+
+    for (int i = 0; i < knownClientHellos.size(); i++) {
+        if (!test->isExcludedBy(knownClientHellos.at(i)))
+            return false;
+    }
+
+    setInferredResult(test, SslTest::SSLTEST_RESULT_SUCCESS,
+                      "test passed (inferred), client does not offer the tested protocol or ciphers");
+
+    return true;
+}
+
+bool SslCAudit::inferFromResultCache(SslTest *test)
+{
+    // all clients audited by the previous test have to be known and to have the same result
+    if (knownClientHellos.isEmpty())
+        return false;
+
+    SslResultCache::Result cached;
+    QByteArray fingerprint = knownClientHellos.first().fingerprint();
+    if (!SslResultCache::load(fingerprint, test->id(), &cached))
+        return false;
+
+    for (int i = 1; i < knownClientHellos.size(); i++) {
+        SslResultCache::Result other;
+        if (!SslResultCache::load(knownClientHellos.at(i).fingerprint(), test->id(), &other)
+                || (other.result != cached.result))
+            return false;
+    }
+
+    setInferredResult(test, cached.result,
+                      QString("%1 (cached result of client %2)").arg(cached.report).arg(QString(fingerprint)));
+
+    return true;
+}
+
+void SslCAudit::storeResults(const SslTest *test)
+{
+    QList<const SslTest *> tests;
+
+    if (clientsTests.contains(test->id())) {
+        foreach (const SslTest *clientTest, clientsTests.value(test->id())) {
+            tests << clientTest;
+        }
     } else {
-        VERBOSE("could not establish encrypted connection (" + sslServer->errorString() + ")");
+        tests << test;
     }
 
-    sslServer->close();
-    sslServer->deleteLater();
+    for (int i = 0; i < tests.size(); i++) {
+        // only measured and definite results are worth keeping
+        if (tests.at(i)->isInferred()
+                || (tests.at(i)->result() == SslTest::SSLTEST_RESULT_UNDEFINED)
+                || (tests.at(i)->result() == SslTest::SSLTEST_RESULT_INIT_FAILED))
+            continue;
+
+        SslResultCache::Result result;
+        result.result = tests.at(i)->result();
+        result.report = tests.at(i)->report();
+        SslResultCache::store(tests.at(i)->clientHello().fingerprint(), test->id(), result);
+    }
+}
 
-    test->calcResults();
+void SslCAudit::streamResults(const SslTest *test)
+{
+    // one record per audited client
+    if (!clientsTests.contains(test->id())) {
+        SslResultStream::write(test);
+        return;
+    }
 
-    WHITE("report:");
+    const QList<SslTest *> tests = clientsTests.value(test->id());
+    for (int i = 0; i < tests.size(); i++)
+        SslResultStream::write(tests.at(i));
+}
 
+void SslCAudit::setInferredResult(SslTest *test, int result, const QString &report)
+{
+    WHITE(QString("test #%1: %2 is not run").arg(test->id()).arg(test->description()));
+
+    qDeleteAll(clientsTests.take(test->id()));
+    test->setInferredResult(result, report);
+
+    WHITE("report:");
     test->printReport();
+}
 
-    WHITE("test finished");
+bool SslCAudit::isTestPassed(const SslTest *test) const
+{
+    if (test->isSkipped())
+        return false;
+
+    if (!clientsTests.contains(test->id()))
+        return test->result() == SslTest::SSLTEST_RESULT_SUCCESS;
+
+    // every audited client has to pass
+    const QList<SslTest *> tests = clientsTests.value(test->id());
+    if (tests.isEmpty())
+        return false;
+
+    for (int i = 0; i < tests.size(); i++) {
+        if (tests.at(i)->result() != SslTest::SSLTEST_RESULT_SUCCESS)
+            return false;
+    }
+
+    return true;
 }
 
-void SslCAudit::run()
+void SslCAudit::runCipherEnumeration()
 {
-    do {
-        for (int i = 0; i < sslTests.size(); i++) {
-            VERBOSE("");
-            currentTest = sslTests.at(i);
-            currentTest->clear();
-            runTest(currentTest);
-            VERBOSE("");
+    SslCipherProbeTest probeTest(settings.getEnumCiphersProtocol());
+
+    if (!probeTest.ensurePrepared(settings)) {
+        RED("failed to prepare ciphers enumeration");
+        return;
+    }
+
+    // every probe is a connection offering a group of ciphers, the client accepts it or not
+    SslCipherBisector bisector([&](const QList<XSslCipher> &ciphers) -> SslCipherBisector::ProbeResult {
+        QStringList names;
+        for (int i = 0; i < ciphers.size(); i++) {
+            names << ciphers.at(i).name();
         }
-    } while (settings.getLoopTests());
+
+        VERBOSE("");
+        probeTest.clear();
+        probeTest.setSslCiphers(ciphers);
+        probeTest.setDescription(QString("offering %1 ciphers: %2").arg(ciphers.size()).arg(names.join(":")));
+        currentTest = &probeTest;
+        runTest(&probeTest);
+
+        switch (probeTest.result()) {
+        case SslTest::SSLTEST_RESULT_UNDEFINED:
+            return SslCipherBisector::Failed;
+        case SslTest::SSLTEST_RESULT_SUCCESS:
+        case SslTest::SSLTEST_RESULT_INIT_FAILED:
+            // ciphers the server can not use are not accepted either
+            return SslCipherBisector::Refused;
+        default:
+            return SslCipherBisector::Accepted;
+        }
+    });
+
+    if (!bisector.run(XSslConfiguration::supportedCiphers()))
+        RED("ciphers enumeration was interrupted, the list of accepted ciphers is incomplete");
+
+    currentTest = nullptr;
+    enumeratedCiphers = bisector.acceptedCiphers();
+    enumerationConnections = bisector.probesCount();
+}
+
+// prepares a test in a separate thread
+class SslTestPreparer : public QThread
+{
+public:
+    SslTestPreparer(SslTest *test, const SslUserSettings &settings) :
+        test(test),
+        settings(settings)
+    {
+    }
+
+protected:
+    void run() override
+    {
+        test->ensurePrepared(settings);
+    }
+
+private:
+    SslTest *test;
+    const SslUserSettings &settings;
+
+};
+
+void SslCAudit::run()
+{
+    if (!following) {
+        // loads the library, workers find it already initialized
+        bool supported = XSslSocket::supportsSsl();
+        if (settings.getStartupProfile())
+            SslStartupProfile::addPhase(supported ? "SSL library loaded" : "SSL library not loaded");
+
+        VERBOSE("SSL library used: " + XSslSocket::sslLibraryVersionString());
+    }
+
+    currentServer = prepareSslServer();
+
+    if (!following && settings.getStartupProfile()) {
+        SslStartupProfile::addPhase("listening socket set up");
+        SslStartupProfile::print();
+    }
+
+    // workers only handle connections, they are stopped once all tests are finished
+    if (following)
+        return;
+
+    if (!currentServer) {
+        emit sslTestsFinished();
+
+        this->deleteLater();
+        QThread::currentThread()->quit();
+        return;
+    }
+
+    if (settings.getEnumCiphersProtocol() != XSsl::UnknownProtocol) {
+        runCipherEnumeration();
+    } else {
+        runTests();
+    }
+
+    currentServer->close();
+    currentServer->deleteLater();
+    currentServer = nullptr;
 
     emit sslTestsFinished();
 
@@ -213,17 +663,85 @@ void SslCAudit::run()
     QThread::currentThread()->quit();
 }
 
+void SslCAudit::runTests()
+{
+    // with adaptive planning, tests deciding the results of other ones are run first
+    QList<SslTest *> tests = sslTests;
+    if (settings.getAdaptiveTests())
+        tests = planner.order(sslTests);
+
+    do {
+        planner.reset();
+
+        SslTestPreparer *nextPreparer = nullptr;
+        if (!tests.isEmpty()) {
+            nextPreparer = new SslTestPreparer(tests.first(), settings);
+            nextPreparer->start();
+        }
+
+        for (int i = 0; i < tests.size(); i++) {
+            SslTestPreparer *preparer = nextPreparer;
+            preparer->wait();
+            delete preparer;
+
+            // the next test is prepared while this one waits for its clients
+            nextPreparer = nullptr;
+            if (i + 1 < tests.size()) {
+                nextPreparer = new SslTestPreparer(tests.at(i + 1), settings);
+                nextPreparer->start();
+            }
+
+            currentTest = tests.at(i);
+            if (!currentTest->ensurePrepared(settings)) {
+                VERBOSE("skipping test: " + currentTest->description());
+                continue;
+            }
+
+            VERBOSE("");
+            currentTest->clear();
+
+            if (!inferResult(currentTest)) {
+                runTest(currentTest);
+                storeResults(currentTest);
+                VERBOSE("");
+            }
+
+            if (SslResultStream::isOpen())
+                streamResults(currentTest);
+
+            planner.addResult(currentTest, isTestPassed(currentTest));
+
+            // prepared certificates are not needed anymore
+            currentTest->releasePrepared();
+        }
+
+        // the summary is not printed until the loop is interrupted
+        if (settings.getLoopTests())
+            printPhaseStats();
+    } while (settings.getLoopTests());
+}
+
 void SslCAudit::handleSocketError(QAbstractSocket::SocketError socketError)
 {
     XSslSocket *sslSocket = dynamic_cast<XSslSocket*>(sender());
     QString errorStr = sslSocket->errorString();
     int errorCode = sslSocket->error();
 
+    SslTest *test = socketTest(sslSocket);
+
     VERBOSE(QString("ssl error: %1 (%2)").arg(errorStr).arg(errorCode));
 
-    currentTest->addSslErrors(sslSocket->sslErrors());
-    currentTest->addSslErrorString(errorStr);
-    currentTest->addSocketErrors(QList<QAbstractSocket::SocketError>() << socketError);
+    test->addSslErrors(sslSocket->sslErrors());
+    test->addSslErrorString(errorStr);
+    test->addSocketErrors(QList<QAbstractSocket::SocketError>() << socketError);
+
+    SslHandshakeLog &log = test->handshakeLog();
+#ifdef UNSAFE
+    log.addEvents(sslSocket->handshakeEvents());
+#else
+    if (socketError == QAbstractSocket::SslHandshakeFailedError)
+        log.addErrorString(errorStr);
+#endif
 
     switch (socketError) {
     case QAbstractSocket::SslInvalidUserDataError:
@@ -233,9 +751,9 @@ void SslCAudit::handleSocketError(QAbstractSocket::SocketError socketError)
         VERBOSE("\tThe SSL library being used reported an internal error. This is probably the result of a bad installation or misconfiguration of the library.");
         break;
     case QAbstractSocket::SslHandshakeFailedError:
-        if (errorStr.contains(QString("ssl3_get_client_hello:no shared cipher"))) {
+        if (log.failure() == SslHandshakeLog::FailureNoSharedCipher) {
             VERBOSE("\tThe SSL/TLS handshake failed (client did not provide expected ciphers), so the connection was closed.");
-        } else if (errorStr.contains(QString("ssl3_read_bytes:tlsv1 alert protocol version"))) {
+        } else if (log.hasReceivedAlert(SslHandshakeLog::AlertProtocolVersion)) {
             VERBOSE("\tThe SSL/TLS handshake failed (client refused the proposed protocol), so the connection was closed.");
         } else {
             VERBOSE("\tThe SSL/TLS handshake failed, so the connection was closed.");
@@ -245,20 +763,35 @@ void SslCAudit::handleSocketError(QAbstractSocket::SocketError socketError)
         // just ignore all other errors
         break;
     }
+
+    if (socketError == QAbstractSocket::SslHandshakeFailedError)
+        test->markPhase(SslPhaseTimings::Handshake);
+
+    switch (socketError) {
+    case QAbstractSocket::SslInvalidUserDataError:
+    case QAbstractSocket::SslInternalError:
+    case QAbstractSocket::SslHandshakeFailedError:
+        // the outcome is known (e.g., client sent a fatal alert), do not wait for disconnection
+        finishConnectionLater(sslSocket);
+        break;
+    default:
+        break;
+    }
 }
 
 void SslCAudit::handleSslErrors(const QList<XSslError> &errors)
 {
+    SslTest *test = socketTest(sender());
     XSslError error;
 
     VERBOSE("SSL errors detected:");
 
     foreach (error, errors) {
         VERBOSE("\t" + error.errorString());
-        currentTest->addSslErrorString(error.errorString());
+        test->addSslErrorString(error.errorString());
     }
 
-    currentTest->addSslErrors(errors);
+    test->addSslErrors(errors);
 }
 
 void SslCAudit::sslHandshakeFinished()
@@ -276,7 +809,38 @@ void SslCAudit::sslHandshakeFinished()
         }
     }
 
-    currentTest->setSslConnectionStatus(true);
+    socketTest(sslSocket)->setSslConnectionStatus(true);
+    socketTest(sslSocket)->markPhase(SslPhaseTimings::Handshake);
+}
+
+void SslCAudit::handleSocketReadyRead()
+{
+    XSslSocket *sslSocket = dynamic_cast<XSslSocket*>(sender());
+    QByteArray message = sslSocket->readAll();
+
+    if (message.isEmpty())
+        return;
+
+    VERBOSE("received data: " + QString(message));
+
+    socketTest(sslSocket)->addInterceptedData(message);
+    socketTest(sslSocket)->markPhase(SslPhaseTimings::FirstData);
+
+    // the first bytes of application data decide the test, there is no need to wait for more
+    finishConnectionLater(sslSocket);
+}
+
+void SslCAudit::handleSocketDisconnected()
+{
+    XSslSocket *sslSocket = dynamic_cast<XSslSocket*>(sender());
+
+    if (socketTest(sslSocket)->interceptedData().isEmpty()) {
+        VERBOSE("no data received (" + sslSocket->errorString() + ")");
+    } else {
+        VERBOSE("disconnected");
+    }
+
+    finishConnectionLater(sslSocket);
 }
 
 void SslCAudit::handlePeerVerifyError(const XSslError &error)
@@ -288,9 +852,12 @@ void SslCAudit::handlePeerVerifyError(const XSslError &error)
 static const int testColumnWidth = 64;
 static const int resultColumnWidth = 12;
 
+// table lines are queued with other console messages, thus they keep their order
+// and go to the same output
 static void printTableHSeparator()
 {
-    QTextStream out(stdout);
+    QString line;
+    QTextStream out(&line);
 
     out << "+";
     for (int i = 0; i < testColumnWidth + 2; i++) {
@@ -301,12 +868,14 @@ static void printTableHSeparator()
         out << "-";
     }
     out << "+";
-    out << endl;
+    out.flush();
+    INFO(line);
 }
 
 static void printTableHeaderLine(const QString &c1String, const QString &c2String)
 {
-    QTextStream out(stdout);
+    QString line;
+    QTextStream out(&line);
 
     out.setFieldAlignment(QTextStream::AlignCenter);
 
@@ -319,12 +888,14 @@ static void printTableHeaderLine(const QString &c1String, const QString &c2Strin
     out << c2String;
     out << qSetFieldWidth(0);
     out << " |";
-    out << endl;
+    out.flush();
+    INFO(line);
 }
 
 static void printTableLine(const QString &c1String, const QString &c2String)
 {
-    QTextStream out(stdout);
+    QString line;
+    QTextStream out(&line);
 
     out << "| ";
     out << qSetFieldWidth(testColumnWidth);
@@ -337,11 +908,62 @@ static void printTableLine(const QString &c1String, const QString &c2String)
     out << c2String;
     out << qSetFieldWidth(0);
     out << " |";
-    out << endl;
+    out.flush();
+    INFO(line);
+}
+
+static QString resultString(int result)
+{
+    switch (result) {
+    case SslTest::SSLTEST_RESULT_SUCCESS:
+        return "PASSED";
+    case SslTest::SSLTEST_RESULT_UNDEFINED:
+    case SslTest::SSLTEST_RESULT_INIT_FAILED:
+        return "UNDEFINED";
+    default:
+        return "FAILED";
+    }
+}
+
+static QString resultString(const SslTest *test)
+{
+    // results obtained without a connection are marked
+    if (test->isInferred())
+        return resultString(test->result()) + " *";
+
+    return resultString(test->result());
+}
+
+static void printTestResult(QString testName, const QString &result)
+{
+    while (testName.length() > testColumnWidth) {
+        printTableLine(testName.left(testColumnWidth - 2), "");
+        testName = "  " + testName.mid(testColumnWidth - 2);
+    }
+
+    printTableLine(testName, result);
 }
 
 void SslCAudit::printSummary()
 {
+    if (enumerationConnections >= 0) {
+        WHITE("accepted ciphers:");
+
+        printTableHSeparator();
+        printTableHeaderLine("Cipher", "Result");
+        printTableHSeparator();
+
+        for (int i = 0; i < enumeratedCiphers.size(); i++) {
+            printTestResult(enumeratedCiphers.at(i).name(), "ACCEPTED");
+        }
+
+        printTableHSeparator();
+
+        VERBOSE(QString("%1 accepted ciphers found using %2 connections")
+                .arg(enumeratedCiphers.size()).arg(enumerationConnections));
+        return;
+    }
+
     WHITE("tests results summary table:");
 
     printTableHSeparator();
@@ -349,28 +971,73 @@ void SslCAudit::printSummary()
     printTableHSeparator();
 
     for (int i = 0; i < sslTests.size(); i++) {
-        QString testName = sslTests.at(i)->name();
-        QString result;
+        const SslTest *test = sslTests.at(i);
 
-        while (testName.length() > testColumnWidth) {
-            printTableLine(testName.left(testColumnWidth - 2), "");
-            testName = "  " + testName.mid(testColumnWidth - 2);
+        if (test->isSkipped()) {
+            printTestResult(test->name(), "SKIPPED");
+            continue;
         }
 
-        switch (sslTests.at(i)->result()) {
-        case SslTest::SSLTEST_RESULT_SUCCESS:
-            result = "PASSED";
-            break;
-        case SslTest::SSLTEST_RESULT_UNDEFINED:
-        case SslTest::SSLTEST_RESULT_INIT_FAILED:
-            result = "UNDEFINED";
-            break;
-        default:
-            result = "FAILED";
+        if (!clientsTests.contains(test->id())) {
+            printTestResult(test->name(), resultString(test));
+            continue;
         }
 
-        printTableLine(testName, result);
+        // one line per audited client
+        const QList<SslTest *> tests = clientsTests.value(test->id());
+        for (int j = 0; j < tests.size(); j++) {
+            printTestResult(QString("%1 (%2)").arg(test->name()).arg(tests.at(j)->clientAddress()),
+                            resultString(tests.at(j)));
+        }
     }
 
     printTableHSeparator();
+
+    for (int i = 0; i < sslTests.size(); i++) {
+        if (sslTests.at(i)->isInferred()) {
+            VERBOSE("* the result is inferred, the test was not run (see its report)");
+            break;
+        }
+    }
+
+#ifdef UNSAFE
+    VERBOSE(QString("SSL context cache: %1 hits, %2 misses")
+            .arg(XSslSocket::sslContextCacheHits()).arg(XSslSocket::sslContextCacheMisses()));
+#endif
+
+    if (settings.getLoopTests())
+        printPhaseStats();
+}
+
+static QString formatPhaseMs(qint64 us)
+{
+    return QString::number(us / 1000.0, 'f', 3);
+}
+
+void SslCAudit::printPhaseStats() const
+{
+    if (phaseStats.isEmpty())
+        return;
+
+    WHITE("connection phases (ms, min / median / p99):");
+
+    for (int i = 0; i < sslTests.size(); i++) {
+        const SslTest *test = sslTests.at(i);
+        if (!phaseStats.contains(test->id()))
+            continue;
+
+        const SslPhaseStats stats = phaseStats.value(test->id());
+        INFO(QString("%1 (last %2 connections)").arg(test->name()).arg(stats.count(SslPhaseTimings::Accept)));
+
+        for (int phase = 0; phase < SslPhaseTimings::PhasesCount; phase++) {
+            SslPhaseTimings::Phase p = static_cast<SslPhaseTimings::Phase>(phase);
+            if (stats.count(p) == 0)
+                continue;
+
+            INFO(QString("\t%1 %2 / %3 / %4").arg(SslPhaseTimings::phaseName(p), -12)
+                    .arg(formatPhaseMs(stats.percentile(p, 0)))
+                    .arg(formatPhaseMs(stats.percentile(p, 50)))
+                    .arg(formatPhaseMs(stats.percentile(p, 99))));
+        }
+    }
 }
@@ -4,6 +4,11 @@
 
 #include <QObject>
 #include <QAbstractSocket>
+#include <QHash>
+#include <QMap>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QSharedPointer>
 
 #ifdef UNSAFE
 #include "sslunsafeerror.h"
@@ -13,6 +18,8 @@
 
 #include "sslusersettings.h"
 #include "ssltest.h"
+#include "ssltestplanner.h"
+#include "ssltestround.h"
 
 
 class SslCAudit : public QObject
@@ -21,8 +28,12 @@ class SslCAudit : public QObject
 
 public:
     SslCAudit(const SslUserSettings settings, QObject *parent = 0);
+    ~SslCAudit();
 
     void setSslTests(const QList<SslTest *> &tests);
+    // the worker accepts connections on the same port for the tests run by this instance,
+    // it has to be added before either of them is started
+    void addWorker(SslCAudit *worker);
 
     static void showCiphers();
     void printSummary();
@@ -35,20 +46,63 @@ signals:
     void sslTestsFinished();
 
 private slots:
+    void handleNewConnection();
+    void handleClientHello(XSslSocket *sslSocket, const SslClientHello &hello);
+    void handleSslInitFailure(XSslSocket *sslSocket);
+    void handleAcceptError(QAbstractSocket::SocketError socketError);
     void handleSocketError(QAbstractSocket::SocketError socketError);
     void handleSslErrors(const QList<XSslError> &errors);
     void handlePeerVerifyError(const XSslError &error);
     void sslHandshakeFinished();
+    void handleSocketReadyRead();
+    void handleSocketDisconnected();
+    void handleRoundStarted();
+    void handleAcceptingFinished();
+    void stopWorker();
 
 private:
+    void runTests();
     void runTest(SslTest *test);
-    SslServer *prepareSslServer(const SslTest *test);
-    void proxyConnection(XSslSocket *sslSocket, SslTest *test);
+    void runCipherEnumeration();
+    SslServer *prepareSslServer();
+    void configureSslServer(SslServer *sslServer, const SslTest *test);
     void handleIncomingConnection(XSslSocket *sslSocket, SslTest *test);
+    void finishConnection(XSslSocket *sslSocket, SslTest *test);
+    void finishConnectionLater(XSslSocket *sslSocket);
+    SslTest *socketTest(QObject *socket) const;
+    bool perConnectionTests() const;
+    bool inferResult(SslTest *test);
+    bool inferFromClientHellos(SslTest *test);
+    bool inferFromResultCache(SslTest *test);
+    void storeResults(const SslTest *test);
+    void streamResults(const SslTest *test);
+    void setInferredResult(SslTest *test, int result, const QString &report);
+    bool isTestPassed(const SslTest *test) const;
+    void printPhaseStats() const;
 
     SslUserSettings settings;
     QList<SslTest *> sslTests;
+    SslTestPlanner planner;
     SslTest *currentTest;
+    SslServer *currentServer;
+    // every accepted connection has its own test context
+    QHash<QObject *, SslTest *> connectionTests;
+    QHash<QObject *, QElapsedTimer> connectionTimers;
+    QHash<QObject *, QTimer *> waitDataTimers;
+    // phase durations of all connections of each test, over all loops
+    QMap<int, SslPhaseStats> phaseStats;
+    // per-client results of each test, filled when several clients are audited
+    QMap<int, QList<SslTest *> > clientsTests;
+    // clients of the running test, shared with workers
+    QSharedPointer<SslTestRound> round;
+    // true for workers added by addWorker()
+    bool following;
+    // ClientHello messages received during the current test and during the last test with connections
+    QList<SslClientHello> currentClientHellos;
+    QList<SslClientHello> knownClientHellos;
+    // outcome of cipher enumeration mode, the count is -1 if it was not run
+    QList<XSslCipher> enumeratedCiphers;
+    int enumerationConnections;
 
 };
 
@@ -0,0 +1,112 @@
+
+#include "sslcertcache.h"
+#include "debug.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QSaveFile>
+
+
+QString SslCertCache::cacheDirectory;
+
+void SslCertCache::setDirectory(const QString &path)
+{
+    if (!QDir().mkpath(path)) {
+        RED("can not create certificates cache directory " + path);
+        return;
+    }
+
+    cacheDirectory = path;
+}
+
+QString SslCertCache::directory()
+{
+    return cacheDirectory;
+}
+
+bool SslCertCache::isEnabled()
+{
+    return !cacheDirectory.isEmpty();
+}
+
+QByteArray SslCertCache::readFile(const QString &path)
+{
+    QFile file(path);
+
+    if (!file.open(QIODevice::ReadOnly))
+        return QByteArray();
+
+    // cached files are small, mapping them avoids an extra copy into a read buffer
+    qint64 size = file.size();
+    uchar *data = file.map(0, size);
+    if (!data)
+        return file.readAll();
+
+    QByteArray ret(reinterpret_cast<const char *>(data), size);
+    file.unmap(data);
+
+    return ret;
+}
+
+bool SslCertCache::load(const QByteArray &id, QList<XSslCertificate> *chain, XSslKey *key,
+                        XSsl::KeyAlgorithm algorithm)
+{
+    if (!isEnabled())
+        return false;
+
+    QString certPath = QDir(cacheDirectory).filePath(QString::fromLatin1(id) + ".crt");
+    QString keyPath = QDir(cacheDirectory).filePath(QString::fromLatin1(id) + ".key");
+    QFileInfo certInfo(certPath);
+
+    if (!certInfo.exists() || !QFileInfo::exists(keyPath))
+        return false;
+
+    if (certInfo.lastModified().daysTo(QDateTime::currentDateTime()) > maxAgeDays) {
+        QFile::remove(certPath);
+        QFile::remove(keyPath);
+        return false;
+    }
+
+    QList<XSslCertificate> cachedChain = XSslCertificate::fromData(readFile(certPath), XSsl::Pem);
+    XSslKey cachedKey(readFile(keyPath), algorithm, XSsl::Pem, XSsl::PrivateKey);
+
+    if (cachedChain.isEmpty() || cachedKey.isNull()
+            || (cachedChain.first().expiryDate() < QDateTime::currentDateTimeUtc())) {
+        return false;
+    }
+
+    *chain = cachedChain;
+    *key = cachedKey;
+
+    return true;
+}
+
+void SslCertCache::store(const QByteArray &id, const QList<XSslCertificate> &chain, const XSslKey &key)
+{
+    if (!isEnabled() || chain.isEmpty() || key.isNull())
+        return;
+
+    QByteArray certData;
+    for (int i = 0; i < chain.size(); i++) {
+        certData += chain.at(i).toPem();
+    }
+
+    // write atomically, several instances can share the same directory
+    QSaveFile certFile(QDir(cacheDirectory).filePath(QString::fromLatin1(id) + ".crt"));
+    QSaveFile keyFile(QDir(cacheDirectory).filePath(QString::fromLatin1(id) + ".key"));
+
+    if (!keyFile.open(QIODevice::WriteOnly) || !certFile.open(QIODevice::WriteOnly)) {
+        VERBOSE("can not write to certificates cache " + cacheDirectory);
+        return;
+    }
+
+    keyFile.setPermissions(QFileDevice::ReadOwner | QFileDevice::WriteOwner);
+    keyFile.write(key.toPem());
+    certFile.write(certData);
+
+    // the key goes first: a certificate is only looked up together with its key
+    if (keyFile.commit())
+        certFile.commit();
+}
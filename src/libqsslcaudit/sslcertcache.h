@@ -0,0 +1,40 @@
+#ifndef SSLCERTCACHE_H
+#define SSLCERTCACHE_H
+
+#include <QString>
+
+#ifdef UNSAFE
+#include "sslunsafecertificate.h"
+#include "sslunsafekey.h"
+#else
+#include <QSslCertificate>
+#include <QSslKey>
+#endif
+
+
+// Optional on-disk storage of certificates and keys produced by SslCertGen.
+// Entries are identified by a digest of everything the generated certificate
+// depends on (including the signing CA certificate and key), thus changing
+// the CA invalidates them implicitly. Entries older than maxAgeDays are
+// regenerated.
+class SslCertCache
+{
+public:
+    static void setDirectory(const QString &path);
+    static QString directory();
+    static bool isEnabled();
+
+    static bool load(const QByteArray &id, QList<XSslCertificate> *chain, XSslKey *key,
+                     XSsl::KeyAlgorithm algorithm = XSsl::Rsa);
+    static void store(const QByteArray &id, const QList<XSslCertificate> &chain, const XSslKey &key);
+
+    static const int maxAgeDays = 7;
+
+private:
+    static QByteArray readFile(const QString &path);
+
+    static QString cacheDirectory;
+
+};
+
+#endif // SSLCERTCACHE_H
@@ -1,10 +1,12 @@
 
 #include "sslcertgen.h"
+#include "sslkeypool.h"
+#include "sslcertcache.h"
 
 #include <QDebug>
 #include <QFile>
+#include <QCryptographicHash>
 
-#include <keybuilder.h>
 #include <certificaterequestbuilder.h>
 #include <certificaterequest.h>
 #include <certificatebuilder.h>
@@ -19,6 +21,38 @@ SslCertGen::SslCertGen()
 
 }
 
+QString SslCertGen::keyTypeName(KeyType type)
+{
+    switch (type) {
+    case KeyEcP256:
+        return "ec256";
+    case KeyEcP384:
+        return "ec384";
+    case KeyRsa:
+    default:
+        return "rsa";
+    }
+}
+
+bool SslCertGen::keyTypeFromName(const QString &name, KeyType *type)
+{
+    QList<KeyType> types = QList<KeyType>() << KeyRsa << KeyEcP256 << KeyEcP384;
+
+    for (int i = 0; i < types.size(); i++) {
+        if (keyTypeName(types.at(i)) == name) {
+            *type = types.at(i);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+XSsl::KeyAlgorithm SslCertGen::keyAlgorithm(KeyType type)
+{
+    return (type == KeyRsa) ? XSsl::Rsa : XSsl::Ec;
+}
+
 XSslCertificate SslCertGen::certFromFile(const QString &path, XSsl::EncodingFormat format)
 {
     XSslCertificate ret;
@@ -63,7 +97,11 @@ XSslKey SslCertGen::keyFromFile(const QString &path, XSsl::KeyAlgorithm algorith
         return ret;
     }
 
-    ret = XSslKey(keyFile.readAll(), algorithm, format, XSsl::PrivateKey, passPhrase);
+    QByteArray data = keyFile.readAll();
+    ret = XSslKey(data, algorithm, format, XSsl::PrivateKey, passPhrase);
+    // user-supplied keys are not necessarily RSA ones
+    if (ret.isNull() && (algorithm == XSsl::Rsa))
+        ret = XSslKey(data, XSsl::Ec, format, XSsl::PrivateKey, passPhrase);
     if (ret.isNull())
         qDebug() << "failed to read key from file" << path;
 
@@ -167,14 +205,45 @@ static void setCertOptions(CertificateBuilder *builder, bool constrains, bool ca
     builder->setBasicConstraints(constrains);
 }
 
-QPair<XSslCertificate, XSslKey> SslCertGen::genSignedCert(const QString &domain, const XSslKey &ukey)
+// identifies generated certificate in SslCertCache
+static QByteArray certCacheId(const QByteArray &kind, const QByteArray &subject,
+                              SslCertGen::KeyType keyType,
+                              const XSslCertificate &cacert = XSslCertificate(),
+                              const XSslKey &cakey = XSslKey())
+{
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+
+    hash.addData(kind + '\n');
+    hash.addData(subject + '\n');
+    if (!cacert.isNull())
+        hash.addData(cacert.toDer());
+    hash.addData("\n", 1);
+    if (!cakey.isNull())
+        hash.addData(cakey.toDer());
+    hash.addData("\n", 1);
+    hash.addData(SslCertGen::keyTypeName(keyType).toLatin1());
+
+    return hash.result().toHex();
+}
+
+QPair<XSslCertificate, XSslKey> SslCertGen::genSignedCert(const QString &domain, const XSslKey &ukey,
+                                                          KeyType keyType)
 {
     XSslKey key;
+    QByteArray cacheId;
+
+    if (ukey.isNull() && SslCertCache::isEnabled()) {
+        QList<XSslCertificate> cachedChain;
+
+        cacheId = certCacheId("self-signed", domain.toUtf8(), keyType);
+        if (SslCertCache::load(cacheId, &cachedChain, &key, keyAlgorithm(keyType)))
+            return QPair<XSslCertificate, XSslKey>(cachedChain.first(), key);
+    }
 
     // if null key is provided, then generate self-signed certificate with random private key,
     // otherwise, use the provided key
     if (ukey.isNull()) {
-        key = KeyBuilder::generate(XSsl::Rsa, KeyBuilder::StrengthNormal);
+        key = SslKeyPool::instance()->takeKey(keyType);
     } else {
         key = ukey;
     }
@@ -189,18 +258,31 @@ QPair<XSslCertificate, XSslKey> SslCertGen::genSignedCert(const QString &domain,
 
     XSslCertificate cert = builder.signedCertificate(key);
 
+    if (!cacheId.isEmpty())
+        SslCertCache::store(cacheId, QList<XSslCertificate>() << cert, key);
+
     return QPair<XSslCertificate, XSslKey>(cert, key);
 }
 
 QPair<XSslCertificate, XSslKey> SslCertGen::genSignedCertFromTemplate(const XSslCertificate &basecert,
-                                                                      const XSslKey &ukey)
+                                                                      const XSslKey &ukey,
+                                                                      KeyType keyType)
 {
     XSslKey key;
+    QByteArray cacheId;
+
+    if (ukey.isNull() && SslCertCache::isEnabled()) {
+        QList<XSslCertificate> cachedChain;
+
+        cacheId = certCacheId("self-signed-template", basecert.toDer(), keyType);
+        if (SslCertCache::load(cacheId, &cachedChain, &key, keyAlgorithm(keyType)))
+            return QPair<XSslCertificate, XSslKey>(cachedChain.first(), key);
+    }
 
     // if null key is provided, then generate self-signed certificate with random private key,
     // otherwise, use the provided key
     if (ukey.isNull()) {
-        key = KeyBuilder::generate(XSsl::Rsa, KeyBuilder::StrengthNormal);
+        key = SslKeyPool::instance()->takeKey(keyType);
     } else {
         key = ukey;
     }
@@ -220,14 +302,27 @@ QPair<XSslCertificate, XSslKey> SslCertGen::genSignedCertFromTemplate(const XSsl
 
     XSslCertificate cert = builder.signedCertificate(key);
 
+    if (!cacheId.isEmpty())
+        SslCertCache::store(cacheId, QList<XSslCertificate>() << cert, key);
+
     return QPair<XSslCertificate, XSslKey>(cert, key);
 }
 
 QPair<QList<XSslCertificate>, XSslKey> SslCertGen::genSignedByCACert(const QString &domain,
                                                                      const XSslCertificate &cacert,
-                                                                     const XSslKey &cakey)
+                                                                     const XSslKey &cakey,
+                                                                     KeyType keyType)
 {
-    XSslKey leafkey = KeyBuilder::generate(XSsl::Rsa, KeyBuilder::StrengthNormal);
+    QPair<QList<XSslCertificate>, XSslKey> cached;
+    QByteArray cacheId;
+
+    if (SslCertCache::isEnabled()) {
+        cacheId = certCacheId("ca-signed", domain.toUtf8(), keyType, cacert, cakey);
+        if (SslCertCache::load(cacheId, &cached.first, &cached.second, keyAlgorithm(keyType)))
+            return cached;
+    }
+
+    XSslKey leafkey = SslKeyPool::instance()->takeKey(keyType);
 
     CertificateRequest leafreq = genCertRequest(leafkey, domain);
 
@@ -243,14 +338,26 @@ QPair<QList<XSslCertificate>, XSslKey> SslCertGen::genSignedByCACert(const QStri
     QList<XSslCertificate> chain;
     chain.append(leafcert);
     chain.append(cacert);
+    SslCertCache::store(cacheId, chain, leafkey);
+
     return QPair<QList<XSslCertificate>, XSslKey>(chain, leafkey);
 }
 
 QPair<QList<XSslCertificate>, XSslKey> SslCertGen::genSignedByCACertFromTemplate(const XSslCertificate &basecert,
                                                                                  const XSslCertificate &cacert,
-                                                                                 const XSslKey &cakey)
+                                                                                 const XSslKey &cakey,
+                                                                                 KeyType keyType)
 {
-    XSslKey leafkey = KeyBuilder::generate(XSsl::Rsa, KeyBuilder::StrengthNormal);
+    QPair<QList<XSslCertificate>, XSslKey> cached;
+    QByteArray cacheId;
+
+    if (SslCertCache::isEnabled()) {
+        cacheId = certCacheId("ca-signed-template", basecert.toDer(), keyType, cacert, cakey);
+        if (SslCertCache::load(cacheId, &cached.first, &cached.second, keyAlgorithm(keyType)))
+            return cached;
+    }
+
+    XSslKey leafkey = SslKeyPool::instance()->takeKey(keyType);
 
     CertificateRequest leafreq = genCertRequestFromTemplate(leafkey, basecert);
 
@@ -271,15 +378,27 @@ QPair<QList<XSslCertificate>, XSslKey> SslCertGen::genSignedByCACertFromTemplate
     QList<XSslCertificate> chain;
     chain.append(leafcert);
     chain.append(cacert);
+    SslCertCache::store(cacheId, chain, leafkey);
+
     return QPair<QList<XSslCertificate>, XSslKey>(chain, leafkey);
 }
 
 QPair<QList<XSslCertificate>, XSslKey> SslCertGen::genSignedByCACertChain(const QString &domain,
                                                                           const XSslCertificate &cacert,
-                                                                          const XSslKey &cakey)
+                                                                          const XSslKey &cakey,
+                                                                          KeyType keyType)
 {
+    QPair<QList<XSslCertificate>, XSslKey> cached;
+    QByteArray cacheId;
+
+    if (SslCertCache::isEnabled()) {
+        cacheId = certCacheId("ca-signed-chain", domain.toUtf8(), keyType, cacert, cakey);
+        if (SslCertCache::load(cacheId, &cached.first, &cached.second, keyAlgorithm(keyType)))
+            return cached;
+    }
+
     // make an intermediate
-    XSslKey interkey = KeyBuilder::generate(XSsl::Rsa, KeyBuilder::StrengthNormal);
+    XSslKey interkey = SslKeyPool::instance()->takeKey(keyType);
 
     CertificateRequest interreq = genCertRequest(interkey, "", "Gremwell Intermediate Auth");
 
@@ -294,7 +413,7 @@ QPair<QList<XSslCertificate>, XSslKey> SslCertGen::genSignedByCACertChain(const
     XSslCertificate intercert = interbuilder.signedCertificate(cacert, cakey);
 
     // Create the leaf
-    XSslKey leafkey = KeyBuilder::generate(XSsl::Rsa, KeyBuilder::StrengthNormal);
+    XSslKey leafkey = SslKeyPool::instance()->takeKey(keyType);
 
     CertificateRequest leafreq = genCertRequest(leafkey, domain);
 
@@ -312,5 +431,7 @@ QPair<QList<XSslCertificate>, XSslKey> SslCertGen::genSignedByCACertChain(const
     chain.append(leafcert);
     chain.append(intercert);
     chain.append(cacert);
+    SslCertCache::store(cacheId, chain, leafkey);
+
     return QPair<QList<XSslCertificate>, XSslKey>(chain, leafkey);
 }
@@ -14,8 +14,19 @@
 class SslCertGen
 {
 public:
+    // type of private keys generated for certificates
+    enum KeyType {
+        KeyRsa,
+        KeyEcP256,
+        KeyEcP384
+    };
+
     SslCertGen();
 
+    static QString keyTypeName(KeyType type);
+    static bool keyTypeFromName(const QString &name, KeyType *type);
+    static XSsl::KeyAlgorithm keyAlgorithm(KeyType type);
+
     static XSslCertificate certFromFile(const QString &path, XSsl::EncodingFormat format = XSsl::Pem);
 
     static QList<XSslCertificate> certChainFromFile(const QString &path, XSsl::EncodingFormat format = XSsl::Pem);
@@ -23,22 +34,27 @@ public:
     static XSslKey keyFromFile(const QString &path, XSsl::KeyAlgorithm algorithm = XSsl::Rsa,
                                XSsl::EncodingFormat format = XSsl::Pem, const QByteArray &passPhrase = QByteArray());
 
-    static QPair<XSslCertificate, XSslKey> genSignedCert(const QString &domain, const XSslKey &key = XSslKey());
+    static QPair<XSslCertificate, XSslKey> genSignedCert(const QString &domain, const XSslKey &key = XSslKey(),
+                                                         KeyType keyType = KeyRsa);
 
     static QPair<XSslCertificate, XSslKey> genSignedCertFromTemplate(const XSslCertificate &basecert,
-                                                                     const XSslKey &key = XSslKey());
+                                                                     const XSslKey &key = XSslKey(),
+                                                                     KeyType keyType = KeyRsa);
 
     static QPair<QList<XSslCertificate>, XSslKey> genSignedByCACert(const QString &domain,
                                                                     const XSslCertificate &cacert,
-                                                                    const XSslKey &cakey);
+                                                                    const XSslKey &cakey,
+                                                                    KeyType keyType = KeyRsa);
 
     static QPair<QList<XSslCertificate>, XSslKey> genSignedByCACertFromTemplate(const XSslCertificate &basecert,
                                                                                 const XSslCertificate &cacert,
-                                                                                const XSslKey &cakey);
+                                                                                const XSslKey &cakey,
+                                                                                KeyType keyType = KeyRsa);
 
     static QPair<QList<XSslCertificate>, XSslKey> genSignedByCACertChain(const QString &domain,
                                                                          const XSslCertificate &cacert,
-                                                                         const XSslKey &cakey);
+                                                                         const XSslKey &cakey,
+                                                                         KeyType keyType = KeyRsa);
 };
 
 #endif // SSLCERTGEN_H
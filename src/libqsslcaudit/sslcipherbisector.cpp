@@ -0,0 +1,56 @@
+
+#include "sslcipherbisector.h"
+
+
+SslCipherBisector::SslCipherBisector(const ProbeFunction &probe) :
+    m_probe(probe),
+    m_probesCount(0)
+{
+}
+
+SslCipherBisector::ProbeResult SslCipherBisector::probe(const QList<XSslCipher> &ciphers)
+{
+    m_probesCount++;
+    return m_probe(ciphers);
+}
+
+bool SslCipherBisector::run(const QList<XSslCipher> &ciphers)
+{
+    m_acceptedCiphers.clear();
+    m_probesCount = 0;
+
+    if (ciphers.isEmpty())
+        return true;
+
+    return bisect(ciphers, false);
+}
+
+bool SslCipherBisector::bisect(const QList<XSslCipher> &ciphers, bool isAccepted)
+{
+    if (!isAccepted) {
+        ProbeResult result = probe(ciphers);
+        if (result == Failed)
+            return false;
+        if (result == Refused)
+            return true;
+    }
+
+    if (ciphers.size() == 1) {
+        m_acceptedCiphers << ciphers.first();
+        return true;
+    }
+
+    QList<XSslCipher> first = ciphers.mid(0, ciphers.size() / 2);
+    QList<XSslCipher> second = ciphers.mid(ciphers.size() / 2);
+
+    ProbeResult result = probe(first);
+    if (result == Failed)
+        return false;
+
+    if (result == Refused) {
+        // at least one cipher of the group is accepted, thus it is in the second half
+        return bisect(second, true);
+    }
+
+    return bisect(first, true) && bisect(second, false);
+}
@@ -0,0 +1,47 @@
+#ifndef SSLCIPHERBISECTOR_H
+#define SSLCIPHERBISECTOR_H
+
+#include <functional>
+
+#ifdef UNSAFE
+#include "sslunsafecipher.h"
+#else
+#include <QSslCipher>
+#endif
+
+
+// Finds the ciphers a client accepts with as few connections as possible.
+// The server offers a group of ciphers per connection: a refused group is
+// dropped as a whole, an accepted one is split in halves. If the first half
+// of an accepted group is refused, the second one is accepted for sure and is
+// not probed. For k accepted ciphers out of n this takes about k*log2(n) probes.
+class SslCipherBisector
+{
+public:
+    enum ProbeResult {
+        Accepted,
+        Refused,
+        Failed
+    };
+
+    typedef std::function<ProbeResult(const QList<XSslCipher> &)> ProbeFunction;
+
+    SslCipherBisector(const ProbeFunction &probe);
+
+    // false if a probe failed, the found ciphers are still available then
+    bool run(const QList<XSslCipher> &ciphers);
+
+    const QList<XSslCipher> &acceptedCiphers() const { return m_acceptedCiphers; }
+    int probesCount() const { return m_probesCount; }
+
+private:
+    bool bisect(const QList<XSslCipher> &ciphers, bool isAccepted);
+    ProbeResult probe(const QList<XSslCipher> &ciphers);
+
+    ProbeFunction m_probe;
+    QList<XSslCipher> m_acceptedCiphers;
+    int m_probesCount;
+
+};
+
+#endif // SSLCIPHERBISECTOR_H
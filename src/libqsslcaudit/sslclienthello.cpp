@@ -0,0 +1,401 @@
+
+#include "sslclienthello.h"
+
+#include <QStringList>
+#include <QCryptographicHash>
+
+
+static const quint8 handshakeRecordType = 0x16;
+static const quint8 clientHelloMessageType = 0x01;
+
+static const quint16 extServerName = 0x0000;
+static const quint16 extSupportedGroups = 0x000a;
+static const quint16 extEcPointFormats = 0x000b;
+static const quint16 extSupportedVersions = 0x002b;
+
+// big-endian integer of 'bytes' length at 'pos', advances 'pos'
+static bool readUInt(const QByteArray &data, int *pos, int bytes, quint32 *value)
+{
+    if ((*pos < 0) || (data.size() - *pos < bytes))
+        return false;
+
+    quint32 ret = 0;
+    for (int i = 0; i < bytes; i++) {
+        ret = (ret << 8) | static_cast<quint8>(data.at(*pos + i));
+    }
+
+    *pos += bytes;
+    *value = ret;
+    return true;
+}
+
+// length-prefixed vector at 'pos', advances 'pos'
+static bool readVector(const QByteArray &data, int *pos, int lengthBytes, QByteArray *vector)
+{
+    quint32 length;
+
+    if (!readUInt(data, pos, lengthBytes, &length))
+        return false;
+    if (static_cast<quint32>(data.size() - *pos) < length)
+        return false;
+
+    *vector = data.mid(*pos, length);
+    *pos += length;
+    return true;
+}
+
+// joins TLS records until the first handshake message is complete,
+// returns false if more data is needed
+static bool collectHandshakeMessage(const QByteArray &data, QByteArray *message)
+{
+    int pos = 0;
+
+    message->clear();
+
+    while (true) {
+        if (message->size() >= 4) {
+            int msgPos = 1;
+            quint32 length;
+            readUInt(*message, &msgPos, 3, &length);
+            if (static_cast<quint32>(message->size()) >= length + 4) {
+                message->truncate(length + 4);
+                return true;
+            }
+        }
+
+        if (data.size() - pos < 5)
+            return false;
+
+        // the message is cut by a record of another type, nothing else will follow
+        if (static_cast<quint8>(data.at(pos)) != handshakeRecordType)
+            return true;
+
+        int recordPos = pos + 3;
+        quint32 recordLength;
+        readUInt(data, &recordPos, 2, &recordLength);
+        if (static_cast<quint32>(data.size() - recordPos) < recordLength)
+            return false;
+
+        message->append(data.mid(recordPos, recordLength));
+        pos = recordPos + recordLength;
+    }
+}
+
+SslClientHello::SslClientHello() :
+    m_valid(false),
+    m_sslV2(false),
+    m_recordVersion(0),
+    m_version(0)
+{
+}
+
+bool SslClientHello::isComplete(const QByteArray &data)
+{
+    if (data.isEmpty())
+        return false;
+
+    quint8 first = static_cast<quint8>(data.at(0));
+
+    if (first == handshakeRecordType) {
+        QByteArray message;
+        return collectHandshakeMessage(data, &message);
+    }
+
+    // SSLv2 record with 2-byte header
+    if (first & 0x80) {
+        if (data.size() < 2)
+            return false;
+        int length = ((first & 0x7f) << 8) | static_cast<quint8>(data.at(1));
+        return data.size() >= length + 2;
+    }
+
+    // not a TLS handshake at all, waiting is useless
+    return true;
+}
+
+SslClientHello SslClientHello::fromData(const QByteArray &data)
+{
+    SslClientHello hello;
+
+    if (data.isEmpty())
+        return hello;
+
+    quint8 first = static_cast<quint8>(data.at(0));
+
+    if (first == handshakeRecordType) {
+        QByteArray message;
+        int pos = 1;
+        quint32 recordVersion;
+
+        if (!readUInt(data, &pos, 2, &recordVersion) || !collectHandshakeMessage(data, &message))
+            return hello;
+
+        hello.m_recordVersion = recordVersion;
+        hello.m_valid = hello.parseTls(message);
+    } else if (first & 0x80) {
+        hello.m_sslV2 = true;
+        hello.m_recordVersion = 0x0002;
+        hello.m_valid = hello.parseSslV2(data);
+    }
+
+    return hello;
+}
+
+bool SslClientHello::parseTls(const QByteArray &message)
+{
+    int pos = 0;
+    quint32 value;
+    QByteArray vector;
+
+    if (!readUInt(message, &pos, 1, &value) || (value != clientHelloMessageType))
+        return false;
+    pos += 3; // length, already checked
+
+    if (!readUInt(message, &pos, 2, &value))
+        return false;
+    m_version = value;
+
+    pos += 32; // random
+
+    if (!readVector(message, &pos, 1, &vector)) // session id
+        return false;
+
+    if (!readVector(message, &pos, 2, &vector))
+        return false;
+    for (int i = 0; i + 1 < vector.size(); i += 2) {
+        int suitePos = i;
+        readUInt(vector, &suitePos, 2, &value);
+        m_cipherSuites << value;
+    }
+
+    if (!readVector(message, &pos, 1, &vector)) // compression methods
+        return false;
+
+    // extensions are optional
+    if (pos == message.size())
+        return true;
+
+    QByteArray extensions;
+    if (!readVector(message, &pos, 2, &extensions))
+        return false;
+
+    int extPos = 0;
+    while (extPos < extensions.size()) {
+        quint32 type;
+        QByteArray extData;
+
+        if (!readUInt(extensions, &extPos, 2, &type) || !readVector(extensions, &extPos, 2, &extData))
+            return false;
+
+        m_extensions << type;
+        if (!parseExtension(type, extData))
+            return false;
+    }
+
+    return true;
+}
+
+bool SslClientHello::parseExtension(quint16 type, const QByteArray &data)
+{
+    int pos = 0;
+    quint32 value;
+    QByteArray vector;
+
+    switch (type) {
+    case extServerName:
+        if (!readVector(data, &pos, 2, &vector))
+            return false;
+        pos = 0;
+        while (pos < vector.size()) {
+            quint32 nameType;
+            QByteArray name;
+            if (!readUInt(vector, &pos, 1, &nameType) || !readVector(vector, &pos, 2, &name))
+                return false;
+            if ((nameType == 0) && m_serverName.isEmpty())
+                m_serverName = QString::fromLatin1(name);
+        }
+        break;
+    case extSupportedGroups:
+        if (!readVector(data, &pos, 2, &vector))
+            return false;
+        pos = 0;
+        while (readUInt(vector, &pos, 2, &value)) {
+            m_supportedGroups << value;
+        }
+        break;
+    case extEcPointFormats:
+        if (!readVector(data, &pos, 1, &vector))
+            return false;
+        for (int i = 0; i < vector.size(); i++) {
+            m_ecPointFormats << static_cast<quint8>(vector.at(i));
+        }
+        break;
+    case extSupportedVersions:
+        if (!readVector(data, &pos, 1, &vector))
+            return false;
+        pos = 0;
+        while (readUInt(vector, &pos, 2, &value)) {
+            m_supportedVersions << value;
+        }
+        break;
+    default:
+        break;
+    }
+
+    return true;
+}
+
+bool SslClientHello::parseSslV2(const QByteArray &data)
+{
+    int pos = 2; // record header
+    quint32 value;
+    quint32 cipherSpecsLength;
+    quint32 sessionIdLength;
+    quint32 challengeLength;
+
+    if (!readUInt(data, &pos, 1, &value) || (value != clientHelloMessageType))
+        return false;
+
+    if (!readUInt(data, &pos, 2, &value))
+        return false;
+    m_version = value;
+
+    if (!readUInt(data, &pos, 2, &cipherSpecsLength)
+            || !readUInt(data, &pos, 2, &sessionIdLength)
+            || !readUInt(data, &pos, 2, &challengeLength))
+        return false;
+
+    if (static_cast<quint32>(data.size() - pos) < cipherSpecsLength + sessionIdLength + challengeLength)
+        return false;
+
+    for (quint32 i = 0; i + 2 < cipherSpecsLength; i += 3) {
+        readUInt(data, &pos, 3, &value);
+        m_cipherSuites << value;
+    }
+
+    return true;
+}
+
+static quint16 protocolVersion(XSsl::SslProtocol protocol)
+{
+    switch (protocol) {
+    case XSsl::SslV2:
+        return 0x0002;
+    case XSsl::SslV3:
+        return 0x0300;
+    case XSsl::TlsV1_0:
+        return 0x0301;
+    case XSsl::TlsV1_1:
+        return 0x0302;
+    case XSsl::TlsV1_2:
+        return 0x0303;
+    default:
+        // ranges of protocols can not be excluded
+        return 0;
+    }
+}
+
+bool SslClientHello::offersProtocol(XSsl::SslProtocol protocol) const
+{
+    quint16 version = protocolVersion(protocol);
+
+    if (!m_valid || (version == 0))
+        return true;
+
+    // SSLv2 can only be negotiated from SSLv2-compatible ClientHello
+    if (version == 0x0002)
+        return m_sslV2;
+
+    // if present, this extension lists every version the client is willing to use
+    if (!m_supportedVersions.isEmpty())
+        return m_supportedVersions.contains(version);
+
+    return (m_version != 0x0002) && (version <= m_version);
+}
+
+QString SslClientHello::versionString(quint16 version)
+{
+    switch (version) {
+    case 0x0002:
+        return "SSLv2";
+    case 0x0300:
+        return "SSLv3";
+    case 0x0301:
+        return "TLS 1.0";
+    case 0x0302:
+        return "TLS 1.1";
+    case 0x0303:
+        return "TLS 1.2";
+    case 0x0304:
+        return "TLS 1.3";
+    default:
+        return QString("0x%1").arg(version, 4, 16, QLatin1Char('0'));
+    }
+}
+
+QString SslClientHello::description() const
+{
+    if (!m_valid)
+        return "not a valid ClientHello";
+
+    QString ret = QString("%1ClientHello for %2, %3 cipher suites, %4 extensions")
+            .arg(m_sslV2 ? "SSLv2-compatible " : "")
+            .arg(versionString(m_version))
+            .arg(m_cipherSuites.size())
+            .arg(m_extensions.size());
+
+    if (!m_supportedVersions.isEmpty()) {
+        QStringList versions;
+        for (int i = 0; i < m_supportedVersions.size(); i++) {
+            versions << versionString(m_supportedVersions.at(i));
+        }
+        ret += ", supported versions: " + versions.join(" ");
+    }
+
+    if (!m_serverName.isEmpty())
+        ret += ", SNI " + m_serverName;
+
+    return ret;
+}
+
+// reserved values clients add at random (RFC 8701)
+static bool isGrease(quint32 value)
+{
+    return ((value & 0x0f0f) == 0x0a0a) && ((value >> 8) == (value & 0xff));
+}
+
+template <typename T>
+static QString joinValues(const QVector<T> &values)
+{
+    QStringList ret;
+
+    for (int i = 0; i < values.size(); i++) {
+        if (!isGrease(values.at(i)))
+            ret << QString::number(values.at(i));
+    }
+
+    return ret.join("-");
+}
+
+QString SslClientHello::fingerprintString() const
+{
+    if (!m_valid)
+        return QString();
+
+    QStringList fields;
+    fields << QString::number(m_version)
+           << joinValues(m_cipherSuites)
+           << joinValues(m_extensions)
+           << joinValues(m_supportedGroups)
+           << joinValues(m_ecPointFormats);
+
+    return fields.join(",");
+}
+
+QByteArray SslClientHello::fingerprint() const
+{
+    if (!m_valid)
+        return QByteArray();
+
+    return QCryptographicHash::hash(fingerprintString().toLatin1(), QCryptographicHash::Md5).toHex();
+}
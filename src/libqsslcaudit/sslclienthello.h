@@ -0,0 +1,72 @@
+#ifndef SSLCLIENTHELLO_H
+#define SSLCLIENTHELLO_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+#ifdef UNSAFE
+#include "sslunsafe.h"
+#else
+#include <QSsl>
+#endif
+
+
+// Parameters offered by a client in its first handshake message.
+// Both TLS and SSLv2-compatible ClientHello formats are understood. Cipher
+// suites are kept as sent: 16-bit identifiers for TLS, 24-bit cipher specs for
+// SSLv2 (where TLS suites appear as 0x00XXXX, i.e. with the same value).
+class SslClientHello
+{
+public:
+    SslClientHello();
+
+    static SslClientHello fromData(const QByteArray &data);
+    // false if the first handshake message is not fully received yet
+    static bool isComplete(const QByteArray &data);
+
+    bool isValid() const { return m_valid; }
+    bool isSslV2() const { return m_sslV2; }
+    quint16 recordVersion() const { return m_recordVersion; }
+    quint16 version() const { return m_version; }
+    const QVector<quint32> &cipherSuites() const { return m_cipherSuites; }
+    const QVector<quint16> &extensions() const { return m_extensions; }
+    const QVector<quint16> &supportedGroups() const { return m_supportedGroups; }
+    const QVector<quint8> &ecPointFormats() const { return m_ecPointFormats; }
+    const QVector<quint16> &supportedVersions() const { return m_supportedVersions; }
+    QString serverName() const { return m_serverName; }
+
+    // these return true unless the ClientHello proves that the client can not use the parameter
+    bool offersProtocol(XSsl::SslProtocol protocol) const;
+    bool offersCipher(quint32 id) const { return m_cipherSuites.contains(id); }
+
+    QString description() const;
+
+    // JA3-style representation of the offered parameters and its MD5 digest (hex),
+    // GREASE values are skipped thus the fingerprint is stable between connections
+    QString fingerprintString() const;
+    QByteArray fingerprint() const;
+
+    static QString versionString(quint16 version);
+
+    static const int maxSize = 32 * 1024;
+
+private:
+    bool parseTls(const QByteArray &message);
+    bool parseSslV2(const QByteArray &data);
+    bool parseExtension(quint16 type, const QByteArray &data);
+
+    bool m_valid;
+    bool m_sslV2;
+    quint16 m_recordVersion;
+    quint16 m_version;
+    QVector<quint32> m_cipherSuites;
+    QVector<quint16> m_extensions;
+    QVector<quint16> m_supportedGroups;
+    QVector<quint8> m_ecPointFormats;
+    QVector<quint16> m_supportedVersions;
+    QString m_serverName;
+
+};
+
+#endif // SSLCLIENTHELLO_H
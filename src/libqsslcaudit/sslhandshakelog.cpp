@@ -0,0 +1,69 @@
+
+#include "sslhandshakelog.h"
+
+
+// SSL_R_NO_SHARED_CIPHER, the same in all supported OpenSSL versions
+static const quint16 reasonNoSharedCipher = 193;
+
+SslHandshakeLog::SslHandshakeLog()
+{
+    clear();
+}
+
+void SslHandshakeLog::clear()
+{
+    m_receivedAlerts.reset();
+    m_sentAlerts.reset();
+    m_handshakeDone = false;
+    m_failure = FailureNone;
+}
+
+#ifdef UNSAFE
+void SslHandshakeLog::addEvents(const QVector<SslUnsafeHandshakeEvent> &events)
+{
+    for (const SslUnsafeHandshakeEvent &event : events) {
+        switch (event.type) {
+        case SslUnsafeHandshakeEvent::AlertReceived:
+            m_receivedAlerts.set(event.code & 0xff);
+            break;
+        case SslUnsafeHandshakeEvent::AlertSent:
+            m_sentAlerts.set(event.code & 0xff);
+            break;
+        case SslUnsafeHandshakeEvent::HandshakeDone:
+            m_handshakeDone = true;
+            break;
+        case SslUnsafeHandshakeEvent::HandshakeFailed:
+            m_failure = (event.code == reasonNoSharedCipher) ? FailureNoSharedCipher : FailureOther;
+            break;
+        default:
+            break;
+        }
+    }
+}
+#endif
+
+void SslHandshakeLog::addErrorString(const QString &error)
+{
+    // OpenSSL prints received alerts as "... alert <description>"
+    if (error.contains(QLatin1String("alert certificate unknown")))
+        m_receivedAlerts.set(AlertCertificateUnknown);
+    if (error.contains(QLatin1String("alert unknown ca")))
+        m_receivedAlerts.set(AlertUnknownCa);
+    if (error.contains(QLatin1String("alert bad certificate")))
+        m_receivedAlerts.set(AlertBadCertificate);
+    if (error.contains(QLatin1String("alert protocol version")))
+        m_receivedAlerts.set(AlertProtocolVersion);
+
+    if (error.contains(QLatin1String("no shared cipher"))) {
+        m_failure = FailureNoSharedCipher;
+    } else if (!error.isEmpty() && (m_failure == FailureNone)) {
+        m_failure = FailureOther;
+    }
+}
+
+bool SslHandshakeLog::isCertificateRejected() const
+{
+    return hasReceivedAlert(AlertCertificateUnknown)
+            || hasReceivedAlert(AlertUnknownCa)
+            || hasReceivedAlert(AlertBadCertificate);
+}
@@ -0,0 +1,62 @@
+#ifndef SSLHANDSHAKELOG_H
+#define SSLHANDSHAKELOG_H
+
+#include <QString>
+#include <QVector>
+
+#include <bitset>
+
+#ifdef UNSAFE
+#include "sslunsafesocket.h"
+#endif
+
+
+// Alerts and the failure reason of one connection's handshake.
+// With the unsafe SSL library they come as codes from the library callbacks,
+// Qt's own backend only provides its error string, which is translated once.
+class SslHandshakeLog
+{
+public:
+    // alert descriptions, RFC 5246 section 7.2
+    enum Alert : quint8 {
+        AlertHandshakeFailure = 40,
+        AlertBadCertificate = 42,
+        AlertCertificateUnknown = 46,
+        AlertUnknownCa = 48,
+        AlertProtocolVersion = 70,
+    };
+
+    enum Failure {
+        FailureNone,
+        FailureNoSharedCipher,
+        FailureOther
+    };
+
+    SslHandshakeLog();
+
+    void clear();
+
+#ifdef UNSAFE
+    void addEvents(const QVector<SslUnsafeHandshakeEvent> &events);
+#endif
+    // error string of a failed handshake
+    void addErrorString(const QString &error);
+
+    bool hasReceivedAlert(Alert alert) const { return m_receivedAlerts.test(alert); }
+    bool hasSentAlert(Alert alert) const { return m_sentAlerts.test(alert); }
+    bool hasReceivedAnyAlert() const { return m_receivedAlerts.any(); }
+    bool isHandshakeDone() const { return m_handshakeDone; }
+    Failure failure() const { return m_failure; }
+
+    // the client rejected our certificate with an alert
+    bool isCertificateRejected() const;
+
+private:
+    std::bitset<256> m_receivedAlerts;
+    std::bitset<256> m_sentAlerts;
+    bool m_handshakeDone;
+    Failure m_failure;
+
+};
+
+#endif // SSLHANDSHAKELOG_H
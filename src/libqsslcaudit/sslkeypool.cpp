@@ -0,0 +1,94 @@
+
+#include "sslkeypool.h"
+
+#include <keybuilder.h>
+
+QT_USE_NAMESPACE_CERTIFICATE
+
+
+SslKeyPool::SslKeyPool() :
+    poolDepth(0),
+    stopRequested(false)
+{
+}
+
+SslKeyPool *SslKeyPool::instance()
+{
+    static SslKeyPool pool;
+    return &pool;
+}
+
+void SslKeyPool::setDepth(int depth)
+{
+    QMutexLocker locker(&mutex);
+    poolDepth = depth;
+    keyTaken.wakeOne();
+}
+
+int SslKeyPool::depth() const
+{
+    QMutexLocker locker(&mutex);
+    return poolDepth;
+}
+
+XSslKey SslKeyPool::generateKey(SslCertGen::KeyType type)
+{
+    switch (type) {
+    case SslCertGen::KeyEcP256:
+        return KeyBuilder::generate(XSsl::Ec, KeyBuilder::StrengthNormal);
+    case SslCertGen::KeyEcP384:
+        return KeyBuilder::generate(XSsl::Ec, KeyBuilder::StrengthHigh);
+    case SslCertGen::KeyRsa:
+    default:
+        return KeyBuilder::generate(XSsl::Rsa, KeyBuilder::StrengthNormal);
+    }
+}
+
+XSslKey SslKeyPool::takeKey(SslCertGen::KeyType type)
+{
+    if (type != SslCertGen::KeyRsa)
+        return generateKey(type);
+
+    {
+        QMutexLocker locker(&mutex);
+        if (!keys.isEmpty()) {
+            XSslKey key = keys.dequeue();
+            keyTaken.wakeOne();
+            return key;
+        }
+    }
+
+    // do not wait for the worker, it may be busy with another key
+    return generateKey(type);
+}
+
+void SslKeyPool::stop()
+{
+    {
+        QMutexLocker locker(&mutex);
+        stopRequested = true;
+        keyTaken.wakeOne();
+    }
+
+    wait();
+}
+
+void SslKeyPool::run()
+{
+    QMutexLocker locker(&mutex);
+
+    while (!stopRequested) {
+        if (keys.size() >= poolDepth) {
+            keyTaken.wait(&mutex);
+            continue;
+        }
+
+        // key generation is slow, let consumers take keys in the meantime
+        locker.unlock();
+        XSslKey key = generateKey(SslCertGen::KeyRsa);
+        locker.relock();
+
+        if (!key.isNull())
+            keys.enqueue(key);
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef SSLKEYPOOL_H
+#define SSLKEYPOOL_H
+
+#include <QThread>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QQueue>
+
+#include "sslcertgen.h"
+
+#ifdef UNSAFE
+#include "sslunsafekey.h"
+#else
+#include <QSslKey>
+#endif
+
+
+// Keeps a number of pre-generated private keys ready for SslCertGen.
+// The worker thread refills the pool each time a key is taken.
+// Only RSA keys are pooled, EC keys are cheap enough to be generated on demand.
+class SslKeyPool : public QThread
+{
+    Q_OBJECT
+
+public:
+    static SslKeyPool *instance();
+
+    void setDepth(int depth);
+    int depth() const;
+
+    // returns a pooled key, or generates one inline if the pool is empty
+    XSslKey takeKey(SslCertGen::KeyType type = SslCertGen::KeyRsa);
+
+    void stop();
+
+protected:
+    void run() override;
+
+private:
+    SslKeyPool();
+
+    static XSslKey generateKey(SslCertGen::KeyType type);
+
+    mutable QMutex mutex;
+    QWaitCondition keyTaken;
+    QQueue<XSslKey> keys;
+    int poolDepth;
+    bool stopRequested;
+
+};
+
+#endif // SSLKEYPOOL_H
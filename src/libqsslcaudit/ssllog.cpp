@@ -0,0 +1,195 @@
+
+#include "ssllog.h"
+
+#include <QThread>
+#include <QSemaphore>
+#include <QAtomicPointer>
+#include <QGlobalStatic>
+
+#include <stdio.h>
+
+
+QAtomicInt SslLog::minLevel(SslLog::Debug);
+
+namespace {
+
+QAtomicInt outputStream(SslLog::StandardOutput);
+
+FILE *output()
+{
+    return (outputStream.load() == SslLog::StandardError) ? stderr : stdout;
+}
+
+void printMessage(SslLog::Color color, const QString &text)
+{
+    const QByteArray local = text.toLocal8Bit();
+    FILE *out = output();
+
+    switch (color) {
+    case SslLog::Plain:
+        fprintf(out, "%s\n", local.constData());
+        break;
+    case SslLog::Bold:
+        fprintf(out, "\033[1m%s\033[0m\n", local.constData());
+        break;
+    case SslLog::BoldGreen:
+        fprintf(out, "\033[1;32m%s\033[0m\n", local.constData());
+        break;
+    case SslLog::BoldRed:
+        fprintf(out, "\033[1;31m%s\033[0m\n", local.constData());
+        break;
+    }
+}
+
+struct SslLogMessage
+{
+    SslLogMessage() : color(SslLog::Plain), done(nullptr), stop(false) {}
+
+    QAtomicPointer<SslLogMessage> next;
+    SslLog::Color color;
+    QString text;
+    // markers carry no text: flush() waits for done, stop ends the writer
+    QSemaphore *done;
+    bool stop;
+};
+
+// Multiple producers, single consumer queue (a linked list with a stub node):
+// producers only swap the head pointer, the writer thread owns the tail.
+class SslLogWriter : public QThread
+{
+public:
+    SslLogWriter() :
+        head(&stub),
+        tail(&stub)
+    {
+        start(QThread::LowPriority);
+    }
+
+    ~SslLogWriter()
+    {
+        SslLogMessage *marker = new SslLogMessage;
+        marker->stop = true;
+        push(marker);
+        wait();
+
+        if (tail != &stub)
+            delete tail;
+    }
+
+    void push(SslLogMessage *message)
+    {
+        SslLogMessage *prev = head.fetchAndStoreAcquireRelease(message);
+        prev->next.storeRelease(message);
+        pending.release();
+    }
+
+protected:
+    void run() override
+    {
+        forever {
+            pending.acquire();
+            SslLogMessage *message = pop();
+
+            if (message->stop) {
+                fflush(output());
+                return;
+            }
+
+            if (message->done) {
+                fflush(output());
+                message->done->release();
+            } else {
+                printMessage(message->color, message->text);
+                message->text.clear();
+                // the output is flushed once the queue is drained
+                if (pending.available() == 0)
+                    fflush(output());
+            }
+        }
+    }
+
+private:
+    // only called once a message was pushed; the returned message stays
+    // in the queue as its new stub and is deleted by the next call
+    SslLogMessage *pop()
+    {
+        SslLogMessage *next = tail->next.loadAcquire();
+        // the producer swapped the head but did not link its message yet
+        while (!next) {
+            QThread::yieldCurrentThread();
+            next = tail->next.loadAcquire();
+        }
+
+        if (tail != &stub)
+            delete tail;
+        tail = next;
+
+        return next;
+    }
+
+    SslLogMessage stub;
+    QAtomicPointer<SslLogMessage> head;
+    SslLogMessage *tail;
+    QSemaphore pending;
+
+};
+
+}
+
+// destroyed on exit, after all queued messages are written
+Q_GLOBAL_STATIC(SslLogWriter, logWriter)
+
+bool SslLog::levelFromName(const QString &name, Level *level)
+{
+    if (name == QString("debug")) {
+        *level = Debug;
+    } else if (name == QString("verbose")) {
+        *level = Verbose;
+    } else if (name == QString("info")) {
+        *level = Info;
+    } else if (name == QString("error")) {
+        *level = Error;
+    } else {
+        return false;
+    }
+
+    return true;
+}
+
+void SslLog::setLevel(Level level)
+{
+    minLevel.store(level);
+}
+
+void SslLog::setOutput(Output output)
+{
+    // messages queued so far are written to the new output
+    outputStream.store(output);
+}
+
+void SslLog::write(Color color, const QString &message)
+{
+    // messages logged by destructors of other globals are not queued anymore
+    if (logWriter.isDestroyed()) {
+        printMessage(color, message);
+        fflush(output());
+        return;
+    }
+
+    SslLogMessage *entry = new SslLogMessage;
+    entry->color = color;
+    entry->text = message;
+    logWriter()->push(entry);
+}
+
+void SslLog::flush()
+{
+    if (logWriter.isDestroyed())
+        return;
+
+    QSemaphore done;
+    SslLogMessage *marker = new SslLogMessage;
+    marker->done = &done;
+    logWriter()->push(marker);
+    done.acquire();
+}
@@ -0,0 +1,51 @@
+#ifndef SSLLOG_H
+#define SSLLOG_H
+
+#include <QString>
+#include <QAtomicInt>
+
+
+// Console output of the tool, see the macros in debug.h.
+// Messages are queued without locking by the threads producing them and are
+// converted and written to the standard output (or error) by a dedicated writer thread,
+// thus a slow consumer of the output never stalls a handshake. Queued messages
+// are written before the process exits.
+class SslLog
+{
+public:
+    // the values are used by QSSLCAUDIT_LOG_LEVEL, see debug.h
+    enum Level {
+        Debug = 0,
+        Verbose = 1,
+        Info = 2,
+        Error = 3
+    };
+
+    enum Output {
+        StandardOutput,
+        StandardError
+    };
+
+    enum Color {
+        Plain,
+        Bold,
+        BoldGreen,
+        BoldRed
+    };
+
+    static bool levelFromName(const QString &name, Level *level);
+    static void setLevel(Level level);
+    // the standard output is used by default
+    static void setOutput(Output output);
+    static bool isEnabled(Level level) { return level >= minLevel.load(); }
+
+    static void write(Color color, const QString &message);
+    // returns once all messages queued before the call are written
+    static void flush();
+
+private:
+    static QAtomicInt minLevel;
+
+};
+
+#endif // SSLLOG_H
@@ -0,0 +1,100 @@
+#include "sslphasetimings.h"
+
+#include <QStringList>
+
+#include <algorithm>
+
+
+SslPhaseTimings::SslPhaseTimings() :
+    m_last(0)
+{
+    for (int i = 0; i < PhasesCount; i++)
+        m_durations[i] = -1;
+}
+
+void SslPhaseTimings::start()
+{
+    m_timer.start();
+    m_last = 0;
+    for (int i = 0; i < PhasesCount; i++)
+        m_durations[i] = -1;
+}
+
+void SslPhaseTimings::mark(Phase phase)
+{
+    if (!m_timer.isValid())
+        return;
+
+    qint64 now = m_timer.nsecsElapsed() / 1000;
+    if (m_durations[phase] < 0)
+        m_durations[phase] = 0;
+    m_durations[phase] += now - m_last;
+    m_last = now;
+}
+
+QString SslPhaseTimings::toString() const
+{
+    QStringList phases;
+
+    for (int i = 0; i < PhasesCount; i++) {
+        if (m_durations[i] < 0)
+            continue;
+        phases << QString("%1 %2").arg(phaseName(static_cast<Phase>(i)))
+                  .arg(m_durations[i] / 1000.0, 0, 'f', 3);
+    }
+
+    return phases.join(", ");
+}
+
+QString SslPhaseTimings::phaseName(Phase phase)
+{
+    switch (phase) {
+    case Accept:
+        return "accept";
+    case StartTls:
+        return "STARTTLS";
+    case Handshake:
+        return "handshake";
+    case FirstData:
+        return "first data";
+    case Disconnect:
+        return "disconnect";
+    default:
+        break;
+    }
+    return QString();
+}
+
+SslPhaseStats::SslPhaseStats()
+{
+    for (int i = 0; i < SslPhaseTimings::PhasesCount; i++)
+        m_next[i] = 0;
+}
+
+void SslPhaseStats::add(const SslPhaseTimings &timings)
+{
+    for (int i = 0; i < SslPhaseTimings::PhasesCount; i++) {
+        qint64 duration = timings.duration(static_cast<SslPhaseTimings::Phase>(i));
+        if (duration < 0)
+            continue;
+
+        if (m_samples[i].size() < maxSamples) {
+            m_samples[i] << duration;
+        } else {
+            m_samples[i][m_next[i]] = duration;
+            m_next[i] = (m_next[i] + 1) % maxSamples;
+        }
+    }
+}
+
+qint64 SslPhaseStats::percentile(SslPhaseTimings::Phase phase, int percent) const
+{
+    QVector<qint64> samples = m_samples[phase];
+    if (samples.isEmpty())
+        return -1;
+
+    // smallest value not exceeded by the given share of samples
+    int rank = qMax((samples.size() * percent + 99) / 100, 1);
+    std::nth_element(samples.begin(), samples.begin() + rank - 1, samples.end());
+    return samples.at(rank - 1);
+}
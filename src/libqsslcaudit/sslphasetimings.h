@@ -0,0 +1,65 @@
+#ifndef SSLPHASETIMINGS_H
+#define SSLPHASETIMINGS_H
+
+#include <QString>
+#include <QVector>
+#include <QElapsedTimer>
+
+
+// Durations of the phases an audited connection goes through, in microseconds.
+// Every mark() ends a phase: it lasted from the previous mark (or start()) until now.
+// A phase marked several times accumulates its parts.
+class SslPhaseTimings
+{
+public:
+    enum Phase {
+        Accept,         // socket set up and ClientHello received
+        StartTls,       // STARTTLS exchange, if any
+        Handshake,      // from ClientHello until the connection is encrypted or refused
+        FirstData,      // waiting for the first application data
+        Disconnect,     // until the verdict is reached
+        PhasesCount
+    };
+
+    SslPhaseTimings();
+
+    void start();
+    bool isStarted() const { return m_timer.isValid(); }
+    void mark(Phase phase);
+
+    // -1 if the phase was not reached
+    qint64 duration(Phase phase) const { return m_durations[phase]; }
+
+    QString toString() const;
+    static QString phaseName(Phase phase);
+
+private:
+    QElapsedTimer m_timer;
+    qint64 m_last;
+    qint64 m_durations[PhasesCount];
+
+};
+
+// Durations of the same phases over many connections.
+class SslPhaseStats
+{
+public:
+    SslPhaseStats();
+
+    // once maxSamples durations of a phase are kept, the oldest one is replaced
+    void add(const SslPhaseTimings &timings);
+
+    int count(SslPhaseTimings::Phase phase) const { return m_samples[phase].size(); }
+    // nearest-rank percentile of the phase durations, -1 if there are none
+    qint64 percentile(SslPhaseTimings::Phase phase, int percent) const;
+
+    static const int maxSamples = 1024;
+
+private:
+    QVector<qint64> m_samples[SslPhaseTimings::PhasesCount];
+    // where the next sample of each phase is stored once maxSamples are kept
+    int m_next[SslPhaseTimings::PhasesCount];
+
+};
+
+#endif // SSLPHASETIMINGS_H
@@ -0,0 +1,158 @@
+#include "sslrelay.h"
+#include "debug.h"
+
+
+SslRelay::SslRelay(XSslSocket *client, const QHostAddress &upstreamAddr, quint16 upstreamPort,
+                   QObject *parent) :
+    QObject(parent),
+    client(client),
+    upstream(new QTcpSocket(this)),
+    upstreamAddr(upstreamAddr),
+    upstreamPort(upstreamPort),
+    upstreamConnected(false),
+    isFinished(false)
+{
+    // data which is not relayed yet stays in socket buffers, these limits make
+    // the kernel throttle the peer instead of us buffering unlimited amounts
+    client->setReadBufferSize(maxBuffered);
+    upstream->setReadBufferSize(maxBuffered);
+
+    connectTimer.setSingleShot(true);
+}
+
+void SslRelay::start()
+{
+    connect(upstream, &QTcpSocket::connected, this, &SslRelay::handleUpstreamConnected);
+    connect(upstream, static_cast<void(QTcpSocket::*)(QAbstractSocket::SocketError)>(&QTcpSocket::error),
+            this, &SslRelay::handleUpstreamError);
+    connect(upstream, &QTcpSocket::readyRead, this, &SslRelay::handleUpstreamReadyRead);
+    connect(upstream, &QTcpSocket::bytesWritten, this, &SslRelay::handleUpstreamBytesWritten);
+    connect(upstream, &QTcpSocket::disconnected, this, &SslRelay::handleUpstreamDisconnected);
+
+    connect(client, &XSslSocket::readyRead, this, &SslRelay::handleClientReadyRead);
+    connect(client, &XSslSocket::bytesWritten, this, &SslRelay::handleClientBytesWritten);
+    connect(client, &XSslSocket::disconnected, this, &SslRelay::handleClientDisconnected);
+
+    connect(&connectTimer, &QTimer::timeout, this, &SslRelay::handleConnectTimeout);
+
+    upstream->connectToHost(upstreamAddr, upstreamPort);
+    connectTimer.start(connectTimeout);
+}
+
+void SslRelay::handleUpstreamConnected()
+{
+    connectTimer.stop();
+    upstreamConnected = true;
+
+    WHITE("forwarding incoming data to the provided proxy");
+    WHITE("to get test results, relauch this app without 'forward' option");
+
+    // the client could have sent something while we were connecting
+    relay(client, upstream);
+
+    if (client->state() == QAbstractSocket::UnconnectedState)
+        handleClientDisconnected();
+}
+
+void SslRelay::handleUpstreamError(QAbstractSocket::SocketError socketError)
+{
+    Q_UNUSED(socketError)
+
+    // errors of established connection are followed by disconnected()
+    if (upstreamConnected)
+        return;
+
+    RED("can't connect to the forward proxy");
+    finish();
+}
+
+void SslRelay::handleConnectTimeout()
+{
+    RED("can't connect to the forward proxy");
+    upstream->abort();
+    finish();
+}
+
+void SslRelay::handleClientReadyRead()
+{
+    relay(client, upstream);
+}
+
+void SslRelay::handleUpstreamReadyRead()
+{
+    relay(upstream, client);
+}
+
+void SslRelay::handleClientBytesWritten()
+{
+    // there is room in the client's write buffer again
+    relay(upstream, client);
+}
+
+void SslRelay::handleUpstreamBytesWritten()
+{
+    relay(client, upstream);
+}
+
+void SslRelay::handleClientDisconnected()
+{
+    if (!upstreamConnected) {
+        upstream->abort();
+        finish();
+        return;
+    }
+
+    // pass the remaining data and let upstream drain its write buffer before closing
+    relay(client, upstream, true);
+
+    if (upstream->state() == QAbstractSocket::UnconnectedState) {
+        finish();
+    } else {
+        upstream->disconnectFromHost();
+    }
+}
+
+void SslRelay::handleUpstreamDisconnected()
+{
+    relay(upstream, client, true);
+
+    if (client->state() == QAbstractSocket::UnconnectedState) {
+        finish();
+    } else {
+        client->disconnectFromHost();
+    }
+}
+
+void SslRelay::relay(QAbstractSocket *from, QAbstractSocket *to, bool flush)
+{
+    if (!upstreamConnected || isFinished)
+        return;
+
+    while (from->bytesAvailable() > 0) {
+        qint64 room = flush ? from->bytesAvailable() : maxBuffered - to->bytesToWrite();
+        // reading resumes once 'to' emits bytesWritten()
+        if (room <= 0)
+            break;
+
+        QByteArray data = from->read(qMin(room, from->bytesAvailable()));
+        if (data.isEmpty())
+            break;
+
+        if (from == client)
+            emit dataIntercepted(data);
+
+        if (to->state() == QAbstractSocket::ConnectedState)
+            to->write(data);
+    }
+}
+
+void SslRelay::finish()
+{
+    if (isFinished)
+        return;
+
+    isFinished = true;
+    connectTimer.stop();
+
+    emit finished();
+}
@@ -0,0 +1,65 @@
+#ifndef SSLRELAY_H
+#define SSLRELAY_H
+
+#include <QObject>
+#include <QTcpSocket>
+#include <QHostAddress>
+#include <QTimer>
+
+#ifdef UNSAFE
+#include "sslunsafesocket.h"
+#else
+#include <QSslSocket>
+#endif
+
+
+// Forwards decrypted client data to the upstream host and upstream replies back
+// to the client. Everything is driven by socket signals, thus any number of
+// relays can be served by a single event loop.
+// Each direction holds at most maxBuffered bytes: once the receiving side has that
+// much data pending to write, reading from the sending side stops (and the TCP
+// window closes) until bytesWritten() is received.
+class SslRelay : public QObject
+{
+    Q_OBJECT
+
+public:
+    SslRelay(XSslSocket *client, const QHostAddress &upstreamAddr, quint16 upstreamPort,
+             QObject *parent = 0);
+
+    void start();
+
+    static const qint64 maxBuffered = 256 * 1024;
+    static const int connectTimeout = 2000;
+
+signals:
+    // plain data sent by the client
+    void dataIntercepted(const QByteArray &data);
+    void finished();
+
+private slots:
+    void handleUpstreamConnected();
+    void handleUpstreamError(QAbstractSocket::SocketError socketError);
+    void handleConnectTimeout();
+    void handleClientReadyRead();
+    void handleUpstreamReadyRead();
+    void handleClientBytesWritten();
+    void handleUpstreamBytesWritten();
+    void handleClientDisconnected();
+    void handleUpstreamDisconnected();
+
+private:
+    void relay(QAbstractSocket *from, QAbstractSocket *to, bool flush = false);
+    void finish();
+
+    XSslSocket *client;
+    QTcpSocket *upstream;
+    QHostAddress upstreamAddr;
+    quint16 upstreamPort;
+    QTimer connectTimer;
+    bool upstreamConnected;
+    bool isFinished;
+
+};
+
+#endif // SSLRELAY_H
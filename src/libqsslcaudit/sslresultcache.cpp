@@ -0,0 +1,175 @@
+
+#include "sslresultcache.h"
+#include "sslusersettings.h"
+#include "debug.h"
+
+#include <QDir>
+#include <QFile>
+#include <QDateTime>
+#include <QSaveFile>
+#include <QTextStream>
+#include <QStringList>
+#include <QCryptographicHash>
+
+#ifdef UNSAFE
+#include "sslunsafeconfiguration.h"
+#else
+#include <QSslConfiguration>
+#endif
+
+
+QString SslResultCache::cacheDirectory;
+QByteArray SslResultCache::settingsData;
+QByteArray SslResultCache::digest;
+
+void SslResultCache::setDirectory(const QString &path)
+{
+    if (!QDir().mkpath(path)) {
+        RED("can not create results cache directory " + path);
+        return;
+    }
+
+    cacheDirectory = path;
+}
+
+QString SslResultCache::directory()
+{
+    return cacheDirectory;
+}
+
+bool SslResultCache::isEnabled()
+{
+    return !cacheDirectory.isEmpty();
+}
+
+static void addCertificates(QCryptographicHash *hash, const QList<XSslCertificate> &certs)
+{
+    for (int i = 0; i < certs.size(); i++)
+        hash->addData(certs.at(i).toDer());
+    hash->addData("\n", 1);
+}
+
+void SslResultCache::setSettings(const SslUserSettings &settings)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+
+    hash.addData(settings.getUserCN().toUtf8() + '\n');
+    hash.addData(settings.getServerAddr().toUtf8() + '\n');
+    addCertificates(&hash, settings.getPeerCertificates());
+    addCertificates(&hash, settings.getUserCert());
+    if (!settings.getUserKey().isNull())
+        hash.addData(settings.getUserKey().toDer());
+    hash.addData("\n", 1);
+    addCertificates(&hash, settings.getUserCaCert());
+    if (!settings.getUserCaKey().isNull())
+        hash.addData(settings.getUserCaKey().toDer());
+    hash.addData("\n", 1);
+    hash.addData(SslCertGen::keyTypeName(settings.getCertKeyType()).toLatin1());
+
+    settingsData = hash.result();
+    digest.clear();
+}
+
+// the ciphers tested depend on the SSL library, which is only loaded once the first
+// test runs; the cache is only used by the thread running the tests
+QByteArray SslResultCache::settingsDigest()
+{
+    if (!digest.isEmpty())
+        return digest;
+
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(settingsData);
+
+    const QList<XSslCipher> ciphers = XSslConfiguration::supportedCiphers();
+    for (int i = 0; i < ciphers.size(); i++)
+        hash.addData(ciphers.at(i).name().toLatin1() + ':');
+
+    digest = hash.result().toHex().left(16);
+    return digest;
+}
+
+QString SslResultCache::filePath(const QByteArray &fingerprint)
+{
+    return QDir(cacheDirectory).filePath(QString("%1-%2.results")
+                                         .arg(QString::fromLatin1(fingerprint))
+                                         .arg(QString::fromLatin1(settingsDigest())));
+}
+
+// every line is "<test id>\t<stored>\t<result>\t<report>", expired entries are dropped
+QHash<int, SslResultCache::Result> SslResultCache::readResults(const QString &path)
+{
+    QHash<int, Result> ret;
+    QFile file(path);
+
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return ret;
+
+    QTextStream in(&file);
+    while (!in.atEnd()) {
+        QStringList fields = in.readLine().split('\t');
+        if (fields.size() != 4)
+            continue;
+
+        bool idOk, storedOk, resultOk;
+        int id = fields.at(0).toInt(&idOk);
+        Result result;
+        result.stored = fields.at(1).toLongLong(&storedOk);
+        result.result = fields.at(2).toInt(&resultOk);
+        result.report = fields.at(3);
+
+        if (!idOk || !storedOk || !resultOk)
+            continue;
+
+        if (QDateTime::fromMSecsSinceEpoch(result.stored).daysTo(QDateTime::currentDateTime()) > maxAgeDays)
+            continue;
+
+        ret.insert(id, result);
+    }
+
+    return ret;
+}
+
+bool SslResultCache::load(const QByteArray &fingerprint, int testId, Result *result)
+{
+    if (!isEnabled() || fingerprint.isEmpty())
+        return false;
+
+    QHash<int, Result> results = readResults(filePath(fingerprint));
+    if (!results.contains(testId))
+        return false;
+
+    *result = results.value(testId);
+
+    return true;
+}
+
+void SslResultCache::store(const QByteArray &fingerprint, int testId, const Result &result)
+{
+    if (!isEnabled() || fingerprint.isEmpty())
+        return;
+
+    QString path = filePath(fingerprint);
+    QHash<int, Result> results = readResults(path);
+
+    Result entry = result;
+    entry.stored = QDateTime::currentMSecsSinceEpoch();
+    results.insert(testId, entry);
+
+    // write atomically, several instances can share the same directory
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        VERBOSE("can not write to results cache " + cacheDirectory);
+        return;
+    }
+
+    QTextStream out(&file);
+    QHash<int, Result>::const_iterator it;
+    for (it = results.constBegin(); it != results.constEnd(); ++it) {
+        QString report = it.value().report;
+        report.replace('\t', ' ').replace('\n', ' ');
+        out << it.key() << '\t' << it.value().stored << '\t' << it.value().result << '\t' << report << '\n';
+    }
+    out.flush();
+
+    file.commit();
+}
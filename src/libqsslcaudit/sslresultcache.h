@@ -0,0 +1,47 @@
+#ifndef SSLRESULTCACHE_H
+#define SSLRESULTCACHE_H
+
+#include <QString>
+#include <QHash>
+
+class SslUserSettings;
+
+
+// Optional on-disk storage of test results per client build.
+// Clients are identified by the fingerprint of their ClientHello (see
+// SslClientHello::fingerprint()). Verdicts also depend on the certificates,
+// keys and ciphers the tool presents, thus every fingerprint has its own file
+// per digest of these settings, with one line per test. Results stored more
+// than maxAgeDays ago are not used.
+class SslResultCache
+{
+public:
+    struct Result {
+        int result;
+        QString report;
+        // milliseconds since epoch
+        qint64 stored;
+    };
+
+    static void setDirectory(const QString &path);
+    static void setSettings(const SslUserSettings &settings);
+    static QString directory();
+    static bool isEnabled();
+
+    static bool load(const QByteArray &fingerprint, int testId, Result *result);
+    static void store(const QByteArray &fingerprint, int testId, const Result &result);
+
+    static const int maxAgeDays = 7;
+
+private:
+    static QHash<int, Result> readResults(const QString &path);
+    static QString filePath(const QByteArray &fingerprint);
+    static QByteArray settingsDigest();
+
+    static QString cacheDirectory;
+    static QByteArray settingsData;
+    static QByteArray digest;
+
+};
+
+#endif // SSLRESULTCACHE_H
@@ -0,0 +1,206 @@
+
+#include "sslresultstream.h"
+#include "ssltest.h"
+#include "debug.h"
+
+#include <QDateTime>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStringList>
+
+#include <stdio.h>
+
+
+QMutex SslResultStream::mutex;
+QFile SslResultStream::file;
+SslResultStream::Format SslResultStream::streamFormat = SslResultStream::JsonLines;
+
+bool SslResultStream::formatFromName(const QString &name, Format *format)
+{
+    if (name == QString("jsonl")) {
+        *format = JsonLines;
+        return true;
+    } else if (name == QString("csv")) {
+        *format = Csv;
+        return true;
+    }
+
+    return false;
+}
+
+bool SslResultStream::open(const QString &path, Format format)
+{
+    QMutexLocker locker(&mutex);
+
+    bool ok;
+    if (path == QString("-")) {
+        ok = file.open(stdout, QIODevice::WriteOnly);
+        // the standard output only holds records
+        if (ok)
+            SslLog::setOutput(SslLog::StandardError);
+    } else {
+        file.setFileName(path);
+        ok = file.open(QIODevice::WriteOnly | QIODevice::Append);
+    }
+
+    if (!ok) {
+        RED("can not open results file " + path);
+        return false;
+    }
+
+    streamFormat = format;
+
+    // a file continued by another run already has its header
+    if ((streamFormat == Csv) && (file.size() == 0)) {
+        file.write(csvHeader());
+        file.flush();
+    }
+
+    return true;
+}
+
+bool SslResultStream::isOpen()
+{
+    QMutexLocker locker(&mutex);
+    return file.isOpen();
+}
+
+void SslResultStream::write(const SslTest *test)
+{
+    QMutexLocker locker(&mutex);
+
+    if (!file.isOpen())
+        return;
+
+    file.write((streamFormat == Csv) ? csvRecord(test) : jsonRecord(test));
+    file.flush();
+}
+
+static QString currentTime()
+{
+    return QDateTime::currentDateTimeUtc().toString("yyyy-MM-ddTHH:mm:ss.zzzZ");
+}
+
+// the same names are used as JSON keys and CSV columns
+static QString phaseKey(SslPhaseTimings::Phase phase)
+{
+    return SslPhaseTimings::phaseName(phase).toLower().replace(' ', '_') + "_us";
+}
+
+static QList<int> errorCodes(const SslTest *test)
+{
+    QList<int> ret;
+
+    const QList<QAbstractSocket::SocketError> &socketErrors = test->socketErrors();
+    for (int i = 0; i < socketErrors.size(); i++)
+        ret << socketErrors.at(i);
+
+    return ret;
+}
+
+static QList<int> sslErrorCodes(const SslTest *test)
+{
+    QList<int> ret;
+
+    const QList<XSslError> &sslErrors = test->sslErrors();
+    for (int i = 0; i < sslErrors.size(); i++)
+        ret << sslErrors.at(i).error();
+
+    return ret;
+}
+
+QByteArray SslResultStream::jsonRecord(const SslTest *test)
+{
+    QJsonObject record;
+
+    record.insert("time", currentTime());
+    record.insert("id", test->id());
+    record.insert("name", test->name());
+    record.insert("result", test->result());
+    record.insert("report", test->report());
+    record.insert("inferred", test->isInferred());
+    record.insert("client", test->clientAddress());
+    record.insert("fingerprint", QString::fromLatin1(test->clientHello().fingerprint()));
+
+    QJsonArray socketErrors;
+    foreach (int code, errorCodes(test))
+        socketErrors.append(code);
+    record.insert("socket_errors", socketErrors);
+
+    QJsonArray sslErrors;
+    foreach (int code, sslErrorCodes(test))
+        sslErrors.append(code);
+    record.insert("ssl_errors", sslErrors);
+
+    record.insert("intercepted_bytes", test->interceptedDataSize());
+    record.insert("verdict_ms", test->verdictTime());
+
+    // phases which were not reached are left out
+    QJsonObject phases;
+    for (int i = 0; i < SslPhaseTimings::PhasesCount; i++) {
+        SslPhaseTimings::Phase phase = static_cast<SslPhaseTimings::Phase>(i);
+        qint64 duration = test->phaseTimings().duration(phase);
+        if (duration >= 0)
+            phases.insert(phaseKey(phase), duration);
+    }
+    record.insert("phases", phases);
+
+    return QJsonDocument(record).toJson(QJsonDocument::Compact) + '\n';
+}
+
+static QString csvField(const QString &value)
+{
+    if (!value.contains(',') && !value.contains('"') && !value.contains('\n'))
+        return value;
+
+    QString quoted = value;
+    quoted.replace('"', "\"\"");
+    return '"' + quoted + '"';
+}
+
+static QString csvList(const QList<int> &values)
+{
+    QStringList ret;
+    for (int i = 0; i < values.size(); i++)
+        ret << QString::number(values.at(i));
+    return ret.join(';');
+}
+
+QByteArray SslResultStream::csvHeader()
+{
+    QStringList fields;
+
+    fields << "time" << "id" << "name" << "result" << "report" << "inferred" << "client" << "fingerprint"
+           << "socket_errors" << "ssl_errors" << "intercepted_bytes" << "verdict_ms";
+    for (int i = 0; i < SslPhaseTimings::PhasesCount; i++)
+        fields << phaseKey(static_cast<SslPhaseTimings::Phase>(i));
+
+    return fields.join(',').toUtf8() + '\n';
+}
+
+QByteArray SslResultStream::csvRecord(const SslTest *test)
+{
+    QStringList fields;
+
+    fields << currentTime()
+           << QString::number(test->id())
+           << csvField(test->name())
+           << QString::number(test->result())
+           << csvField(test->report())
+           << (test->isInferred() ? "1" : "0")
+           << csvField(test->clientAddress())
+           << QString::fromLatin1(test->clientHello().fingerprint())
+           << csvList(errorCodes(test))
+           << csvList(sslErrorCodes(test))
+           << QString::number(test->interceptedDataSize())
+           << QString::number(test->verdictTime());
+
+    // empty if the phase was not reached
+    for (int i = 0; i < SslPhaseTimings::PhasesCount; i++) {
+        qint64 duration = test->phaseTimings().duration(static_cast<SslPhaseTimings::Phase>(i));
+        fields << ((duration >= 0) ? QString::number(duration) : QString());
+    }
+
+    return fields.join(',').toUtf8() + '\n';
+}
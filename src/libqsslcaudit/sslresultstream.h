@@ -0,0 +1,40 @@
+#ifndef SSLRESULTSTREAM_H
+#define SSLRESULTSTREAM_H
+
+#include <QString>
+#include <QFile>
+#include <QMutex>
+
+class SslTest;
+
+
+// Machine-readable results, one record per completed test (per client when several
+// are audited). Every record is flushed as soon as it is written, thus the file
+// can be followed while the tool runs.
+class SslResultStream
+{
+public:
+    enum Format {
+        JsonLines,
+        Csv
+    };
+
+    static bool formatFromName(const QString &name, Format *format);
+
+    // "-" writes to the standard output, console messages then go to the standard error
+    static bool open(const QString &path, Format format);
+    static bool isOpen();
+    static void write(const SslTest *test);
+
+private:
+    static QByteArray jsonRecord(const SslTest *test);
+    static QByteArray csvRecord(const SslTest *test);
+    static QByteArray csvHeader();
+
+    static QMutex mutex;
+    static QFile file;
+    static Format streamFormat;
+
+};
+
+#endif // SSLRESULTSTREAM_H
@@ -21,6 +21,14 @@
 #include "starttls.h"
 
 #include <QFile>
+#include <QTimer>
+
+#ifdef Q_OS_UNIX
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <unistd.h>
+#include <string.h>
+#endif
 
 #ifdef UNSAFE
 #include "sslunsafeconfiguration.h"
@@ -40,8 +48,57 @@ SslServer::SslServer(QObject *parent) : QTcpServer(parent),
 {
 }
 
+bool SslServer::listenShared(const QHostAddress &address, quint16 port)
+{
+#if defined(Q_OS_UNIX) && defined(SO_REUSEPORT)
+    bool ipv6 = (address.protocol() == QAbstractSocket::IPv6Protocol);
+    struct sockaddr_storage addr;
+    socklen_t addrLen;
+    int on = 1;
+
+    memset(&addr, 0, sizeof(addr));
+    if (ipv6) {
+        struct sockaddr_in6 *addr6 = reinterpret_cast<struct sockaddr_in6 *>(&addr);
+        Q_IPV6ADDR ip = address.toIPv6Address();
+        addr6->sin6_family = AF_INET6;
+        addr6->sin6_port = htons(port);
+        memcpy(&addr6->sin6_addr, &ip, sizeof(ip));
+        addrLen = sizeof(*addr6);
+    } else {
+        struct sockaddr_in *addr4 = reinterpret_cast<struct sockaddr_in *>(&addr);
+        addr4->sin_family = AF_INET;
+        addr4->sin_port = htons(port);
+        addr4->sin_addr.s_addr = htonl(address.toIPv4Address());
+        addrLen = sizeof(*addr4);
+    }
+
+    int fd = ::socket(ipv6 ? AF_INET6 : AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+        return false;
+
+    if ((::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on)) < 0)
+            || (::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on)) < 0)
+            || (::bind(fd, reinterpret_cast<struct sockaddr *>(&addr), addrLen) < 0)
+            || (::listen(fd, maxPendingConnections()) < 0)
+            || !setSocketDescriptor(fd)) {
+        ::close(fd);
+        return false;
+    }
+
+    return true;
+#else
+    Q_UNUSED(address);
+    Q_UNUSED(port);
+    RED("shared listening ports are not supported on this platform");
+    return false;
+#endif
+}
+
 void SslServer::incomingConnection(qintptr socketDescriptor)
 {
+    SslPhaseTimings timings;
+    timings.start();
+
     XSslSocket *sslSocket = new XSslSocket(this);
 
     if (!sslSocket->setSocketDescriptor(socketDescriptor)) {
@@ -66,32 +123,94 @@ void SslServer::incomingConnection(qintptr socketDescriptor)
 #if SSLSERVER_ELL_CURVES
     if (!m_sslEllipticCurves.isEmpty())
         sslConf.setEllipticCurves(m_sslEllipticCurves);
+#else
+    // ECDSA certificates can only be used with their own curve, make sure it is offered
+    if ((m_sslPrivateKey.algorithm() == XSsl::Ec) && !m_sslEllipticCurves.isEmpty())
+        sslConf.setEllipticCurves(m_sslEllipticCurves);
 #endif
     /* this is important to set even in server mode to properly verify SSLv3 / SSLv2 support */
     sslConf.setPeerVerifyMode(SslUnsafeSocket::VerifyNone);
 
     sslSocket->setSslConfiguration(sslConf);
 
-    handleStartTls(sslSocket);
+    timings.mark(SslPhaseTimings::Accept);
+    if (m_startTlsProtocol != SslServer::StartTlsUnknownProtocol) {
+        handleStartTls(sslSocket);
+        timings.mark(SslPhaseTimings::StartTls);
+    }
+    m_phaseTimings.insert(sslSocket, timings);
+
+    // the handshake is started once the ClientHello is fully received. Until then the data
+    // stays in the socket buffer, it is only peeked at
+    m_helloPendingSockets.insert(sslSocket);
+    connect(sslSocket, &XSslSocket::readyRead, this, [=]() {
+        handleClientHelloData(sslSocket);
+    });
+    connect(sslSocket, &XSslSocket::disconnected, this, [=]() {
+        handleClientHelloData(sslSocket);
+    });
+    connect(sslSocket, &QObject::destroyed, this, [=]() {
+        m_helloPendingSockets.remove(sslSocket);
+        m_phaseTimings.remove(sslSocket);
+    });
+
+    // the data could have been received during STARTTLS exchange. Checked a bit later,
+    // the connection is not yet handled by the user of newConnection() signal
+    QTimer::singleShot(0, sslSocket, [=]() {
+        handleClientHelloData(sslSocket);
+    });
+}
+
+void SslServer::handleClientHelloData(XSslSocket *socket)
+{
+    if (!m_helloPendingSockets.contains(socket))
+        return;
+
+    QByteArray data = socket->peek(SslClientHello::maxSize);
+
+    if (!SslClientHello::isComplete(data) && (data.size() < SslClientHello::maxSize)
+            && (socket->state() == QAbstractSocket::ConnectedState))
+        return;
+
+    m_helloPendingSockets.remove(socket);
+    socket->disconnect(this);
+
+    emit clientHelloReceived(socket, SslClientHello::fromData(data));
 
+    // the connection could have been closed by the client or by signal handler
+    if (socket->state() == QAbstractSocket::ConnectedState)
+        startEncryption(socket);
+}
+
+void SslServer::startEncryption(XSslSocket *socket)
+{
     m_sslInitErrors.clear();
     m_sslInitErrorsStr.clear();
 
     // this is the only place to handle SSL initialization errors (in error slot)
-    connect(sslSocket, static_cast<void(XSslSocket::*)(QAbstractSocket::SocketError)>(&XSslSocket::error),
+    connect(socket, static_cast<void(XSslSocket::*)(QAbstractSocket::SocketError)>(&XSslSocket::error),
             this, &SslServer::handleSocketError);
 
-    sslSocket->startServerEncryption();
+    socket->startServerEncryption();
 
     // don't interfere with SslCAudit
-    disconnect(sslSocket, static_cast<void(XSslSocket::*)(QAbstractSocket::SocketError)>(&XSslSocket::error),
+    disconnect(socket, static_cast<void(XSslSocket::*)(QAbstractSocket::SocketError)>(&XSslSocket::error),
                this, &SslServer::handleSocketError);
+
+    if (!m_sslInitErrors.isEmpty())
+        emit sslInitFailed(socket);
 }
 
 void SslServer::handleSocketError(QAbstractSocket::SocketError socketError)
 {
     XSslSocket *sslSocket = dynamic_cast<XSslSocket*>(sender());
 
+    // connected during startServerEncryption() only: keep the errors preventing the socket
+    // from starting the handshake, handshake failures are reported to SslCAudit
+    if ((socketError != QAbstractSocket::SslInternalError)
+            && (socketError != QAbstractSocket::SslInvalidUserDataError))
+        return;
+
     m_sslInitErrors << socketError;
     m_sslInitErrorsStr << sslSocket->errorString();
 }
@@ -106,6 +225,11 @@ const QList<QAbstractSocket::SocketError> &SslServer::getSslInitErrors() const
     return m_sslInitErrors;
 }
 
+SslPhaseTimings SslServer::takePhaseTimings(XSslSocket *socket)
+{
+    return m_phaseTimings.take(socket);
+}
+
 const XSslCertificate &SslServer::getSslLocalCertificate() const
 {
     return m_sslLocalCertificate;
@@ -22,6 +22,8 @@
 
 #include <QTcpServer>
 #include <QString>
+#include <QSet>
+#include <QHash>
 
 #ifdef UNSAFE
 #include "sslunsafecertificate.h"
@@ -35,6 +37,9 @@
 #include <QSslCipher>
 #endif
 
+#include "sslclienthello.h"
+#include "sslphasetimings.h"
+
 
 class XSslSocket;
 
@@ -45,6 +50,10 @@ class SslServer : public QTcpServer
 public:
     SslServer(QObject *parent = 0);
 
+    // listens on a port shared with other servers (SO_REUSEPORT), the kernel spreads
+    // incoming connections between them
+    bool listenShared(const QHostAddress &address, quint16 port);
+
     const XSslCertificate &getSslLocalCertificate() const;
     const XSslKey &getSslPrivateKey() const;
     XSsl::SslProtocol getSslProtocol() const;
@@ -75,11 +84,23 @@ public:
     const QStringList &getSslInitErrorsStr() const;
     const QList<QAbstractSocket::SocketError> &getSslInitErrors() const;
 
+    // phases of the connection passed by the server so far, the timings are not kept after this call
+    SslPhaseTimings takePhaseTimings(XSslSocket *socket);
+
+signals:
+    // the first message of the client was peeked, the handshake starts right after this signal
+    // (unless the socket was closed), thus handlers connected here see all handshake events
+    void clientHelloReceived(XSslSocket *socket, const SslClientHello &hello);
+    // SSL initialization errors (see getSslInitErrors()) occurred when starting the handshake
+    void sslInitFailed(XSslSocket *socket);
+
 protected:
     void incomingConnection(qintptr socketDescriptor) override final;
 
 private:
     void handleStartTls(XSslSocket *const socket);
+    void handleClientHelloData(XSslSocket *socket);
+    void startEncryption(XSslSocket *socket);
     void handleSocketError(QAbstractSocket::SocketError socketError);
 
     XSslCertificate m_sslLocalCertificate;
@@ -91,6 +112,9 @@ private:
     SslServer::StartTlsProtocol m_startTlsProtocol;
     QStringList m_sslInitErrorsStr;
     QList<QAbstractSocket::SocketError> m_sslInitErrors;
+    // connections waiting for their ClientHello
+    QSet<XSslSocket *> m_helloPendingSockets;
+    QHash<XSslSocket *, SslPhaseTimings> m_phaseTimings;
 
 };
 
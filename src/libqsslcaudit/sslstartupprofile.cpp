@@ -0,0 +1,53 @@
+
+#include "sslstartupprofile.h"
+#include "debug.h"
+
+
+QMutex SslStartupProfile::mutex;
+QElapsedTimer SslStartupProfile::timer;
+QList<QPair<QString, qint64>> SslStartupProfile::phases;
+
+void SslStartupProfile::start()
+{
+    QMutexLocker locker(&mutex);
+
+    phases.clear();
+    timer.start();
+}
+
+void SslStartupProfile::addPhase(const QString &name)
+{
+    QMutexLocker locker(&mutex);
+
+    if (!timer.isValid())
+        return;
+
+    phases << qMakePair(name, timer.nsecsElapsed() / 1000);
+}
+
+static QString formatMs(qint64 us)
+{
+    return QString::number(us / 1000.0, 'f', 3);
+}
+
+void SslStartupProfile::print()
+{
+    QMutexLocker locker(&mutex);
+
+    if (phases.isEmpty())
+        return;
+
+    WHITE("startup profile (ms):");
+    INFO(QString("%1 %2 %3").arg("phase", -32).arg("duration", 10).arg("elapsed", 10));
+
+    qint64 previous = 0;
+    for (int i = 0; i < phases.size(); i++) {
+        const QPair<QString, qint64> &phase = phases.at(i);
+        INFO(QString("%1 %2 %3").arg(phase.first, -32)
+                .arg(formatMs(phase.second - previous), 10)
+                .arg(formatMs(phase.second), 10));
+        previous = phase.second;
+    }
+
+    INFO(QString("time to listen: %1 ms").arg(formatMs(previous)));
+}
@@ -0,0 +1,29 @@
+#ifndef SSLSTARTUPPROFILE_H
+#define SSLSTARTUPPROFILE_H
+
+#include <QString>
+#include <QList>
+#include <QPair>
+#include <QMutex>
+#include <QElapsedTimer>
+
+
+// Time spent from the process start until the tool listens for clients.
+// Phases are marked from the main thread and from the thread running the tests,
+// each one lasts from the previous mark until its own.
+class SslStartupProfile
+{
+public:
+    static void start();
+    static void addPhase(const QString &name);
+    static void print();
+
+private:
+    static QMutex mutex;
+    static QElapsedTimer timer;
+    // phase name and the time since start() it was completed at, in microseconds
+    static QList<QPair<QString, qint64>> phases;
+
+};
+
+#endif // SSLSTARTUPPROFILE_H
@@ -5,7 +5,8 @@
 #include "ciphers.h"
 
 
-SslTest::SslTest()
+SslTest::SslTest() :
+    m_prepareState(NotPrepared)
 {
     clear();
 }
@@ -65,6 +66,63 @@ SslTest *SslTest::createTest(int id)
     return NULL;
 }
 
+SslTest *SslTest::clone() const
+{
+    // tests which can not be created by their id override clone()
+    SslTest *test = createTest(m_id - 1);
+    Q_ASSERT(test);
+
+    copyPrepared(test);
+
+    return test;
+}
+
+void SslTest::copyPrepared(SslTest *test) const
+{
+    test->setLocalCert(m_localCertsChain);
+    test->setPrivateKey(m_privateKey);
+    test->setSslProtocol(m_sslProtocol);
+    test->setSslCiphers(m_sslCiphers);
+    test->m_prepareState = m_prepareState;
+}
+
+bool SslTest::ensurePrepared(const SslUserSettings &settings)
+{
+    if (m_prepareState == NotPrepared)
+        m_prepareState = prepare(settings) ? Prepared : PrepareFailed;
+
+    return m_prepareState == Prepared;
+}
+
+void SslTest::releasePrepared()
+{
+    // failed preparation is remembered, the test is not retried
+    if (m_prepareState != Prepared)
+        return;
+
+    m_localCertsChain = QList<XSslCertificate>();
+    m_privateKey = XSslKey();
+    m_sslCiphers = QList<XSslCipher>();
+    m_prepareState = NotPrepared;
+}
+
+void SslTest::setInferredResult(int result, const QString &report)
+{
+    m_result = result;
+    m_report = report;
+    m_inferred = true;
+}
+
+bool SslTest::isUnexpectedResult() const
+{
+    if ((m_result == SSLTEST_RESULT_UNDEFINED) || (m_result == SSLTEST_RESULT_INIT_FAILED))
+        return true;
+
+    return m_socketErrors.contains(QAbstractSocket::SslHandshakeFailedError)
+            && (m_handshakeLog.failure() != SslHandshakeLog::FailureNoSharedCipher)
+            && !m_handshakeLog.hasReceivedAnyAlert();
+}
+
 void SslTest::printReport()
 {
     if (m_result < 0) {
@@ -80,20 +138,26 @@ void SslTest::clear()
     m_sslErrorsStr = QStringList();
     m_socketErrors = QList<QAbstractSocket::SocketError>();
     m_sslConnectionEstablished = false;
-    m_interceptedData = QByteArray();
+    m_interceptedData.clear();
+    m_handshakeLog.clear();
+    m_clientAddress = QString();
+    m_clientHello = SslClientHello();
+    m_verdictTime = -1;
+    m_phaseTimings = SslPhaseTimings();
     m_result = SSLTEST_RESULT_UNDEFINED;
+    m_inferred = false;
     m_report = QString("test results undefined");
 }
 
 void SslCertificatesTest::calcResults()
 {
-    if (m_interceptedData.size() > 0) {
+    if (!m_interceptedData.isEmpty()) {
         m_report = QString("test failed, client accepted fake certificate, data was intercepted");
         setResult(SSLTEST_RESULT_DATA_INTERCEPTED);
         return;
     }
 
-    if (m_sslConnectionEstablished && (m_interceptedData.size() == 0)
+    if (m_sslConnectionEstablished && m_interceptedData.isEmpty()
             && !m_socketErrors.contains(QAbstractSocket::RemoteHostClosedError)) {
         m_report = QString("test failed, client accepted fake certificate, but no data transmitted");
         setResult(SSLTEST_RESULT_CERT_ACCEPTED);
@@ -113,13 +177,13 @@ void SslCertificatesTest::calcResults()
 
 void SslProtocolsTest::calcResults()
 {
-    if (m_interceptedData.size() > 0) {
+    if (!m_interceptedData.isEmpty()) {
         m_report = QString("test failed, client accepted fake certificate and weak protocol, data was intercepted");
         setResult(SSLTEST_RESULT_DATA_INTERCEPTED);
         return;
     }
 
-    if (m_sslConnectionEstablished && (m_interceptedData.size() == 0)
+    if (m_sslConnectionEstablished && m_interceptedData.isEmpty()
             && !m_socketErrors.contains(QAbstractSocket::RemoteHostClosedError)) {
         m_report = QString("test failed, client accepted fake certificate and weak protocol, but no data transmitted");
         setResult(SSLTEST_RESULT_CERT_ACCEPTED);
@@ -140,9 +204,7 @@ void SslProtocolsTest::calcResults()
     }
 
     if (m_socketErrors.contains(QAbstractSocket::SslHandshakeFailedError)
-            && ((m_sslErrorsStr.filter(QString("certificate unknown")).size() > 0)
-                || (m_sslErrorsStr.filter(QString("unknown ca")).size() > 0)
-                || (m_sslErrorsStr.filter(QString("bad certificate")).size() > 0))) {
+            && m_handshakeLog.isCertificateRejected()) {
         m_report = QString("test failed, client accepted weak protocol");
         setResult(SSLTEST_RESULT_PROTO_ACCEPTED_WITH_ERR);
         return;
@@ -182,27 +244,47 @@ bool SslProtocolsTest::prepare(const SslUserSettings &settings)
     return setProtoAndCiphers();
 }
 
+void SslProtocolsTest::copyPrepared(SslTest *test) const
+{
+    SslTest::copyPrepared(test);
+
+    static_cast<SslProtocolsTest *>(test)->m_ciphersIds = m_ciphersIds;
+}
+
+bool SslProtocolsTest::isExcludedBy(const SslClientHello &hello) const
+{
+    if (!hello.isValid())
+        return false;
+
+    if (!hello.offersProtocol(m_sslProtocol))
+        return true;
+
+    if (m_ciphersIds.isEmpty())
+        return false;
+
+    for (int i = 0; i < m_ciphersIds.size(); i++) {
+        if (hello.offersCipher(m_ciphersIds.at(i)))
+            return false;
+    }
+
+    return true;
+}
+
 bool SslProtocolsTest::setProtoAndSupportedCiphers(XSsl::SslProtocol proto)
 {
     QList<XSslCipher> ciphers = XSslConfiguration::supportedCiphers();
 
     setSslCiphers(ciphers);
     setSslProtocol(proto);
+    m_ciphersIds.clear();
 
     return true;
 }
 
-bool SslProtocolsTest::setProtoAndSpecifiedCiphers(XSsl::SslProtocol proto, QString ciphersString, QString name)
+bool SslProtocolsTest::setProtoAndSpecifiedCiphers(XSsl::SslProtocol proto, SslCipherGrade grade, QString name)
 {
-    QList<XSslCipher> ciphers;
-    QStringList opensslCiphers = ciphersString.split(":");
+    const QList<XSslCipher> &ciphers = sslCiphersOfGrade(grade);
 
-    for (int i = 0; i < opensslCiphers.size(); i++) {
-        XSslCipher cipher = XSslCipher(opensslCiphers.at(i));
-
-        if (!cipher.isNull())
-            ciphers << cipher;
-    }
     if (ciphers.size() == 0) {
         VERBOSE(QString("no %1 ciphers available").arg(name));
         return false;
@@ -210,21 +292,22 @@ bool SslProtocolsTest::setProtoAndSpecifiedCiphers(XSsl::SslProtocol proto, QStr
 
     setSslCiphers(ciphers);
     setSslProtocol(proto);
+    m_ciphersIds = sslCipherIdsOfGrade(grade);
 
     return true;
 }
 
 bool SslProtocolsTest::setProtoAndExportCiphers(XSsl::SslProtocol proto)
 {
-    return setProtoAndSpecifiedCiphers(proto, ciphers_export_str, "EXPORT");
+    return setProtoAndSpecifiedCiphers(proto, SslCiphersExport, "EXPORT");
 }
 
 bool SslProtocolsTest::setProtoAndLowCiphers(XSsl::SslProtocol proto)
 {
-    return setProtoAndSpecifiedCiphers(proto, ciphers_low_str, "LOW");
+    return setProtoAndSpecifiedCiphers(proto, SslCiphersLow, "LOW");
 }
 
 bool SslProtocolsTest::setProtoAndMediumCiphers(XSsl::SslProtocol proto)
 {
-    return setProtoAndSpecifiedCiphers(proto, ciphers_medium_str, "MEDIUM");
+    return setProtoAndSpecifiedCiphers(proto, SslCiphersMedium, "MEDIUM");
 }
@@ -16,6 +16,11 @@
 #endif
 
 #include "sslusersettings.h"
+#include "sslcapture.h"
+#include "sslclienthello.h"
+#include "sslhandshakelog.h"
+#include "sslphasetimings.h"
+#include "ciphers.h"
 
 
 class SslTest
@@ -37,10 +42,22 @@ public:
 
     static SslTest *createTest(int id);
 
+    // a copy sharing prepared parameters, with its own results
+    virtual SslTest *clone() const;
+
     virtual bool prepare(const SslUserSettings &settings) = 0;
     virtual void calcResults() = 0;
+    // true if a client which sent such ClientHello certainly passes the (prepared) test
+    virtual bool isExcludedBy(const SslClientHello &hello) const { Q_UNUSED(hello); return false; }
+
+    // calls prepare() unless it was already done, the outcome is kept until releasePrepared()
+    bool ensurePrepared(const SslUserSettings &settings);
+    // drops certificates and other data set by prepare()
+    void releasePrepared();
+    bool isSkipped() const { return m_prepareState == PrepareFailed; }
 
     void printReport();
+    QString report() const { return m_report; }
 
     int id() const { return m_id; }
     void setId(int id) { m_id = id; }
@@ -56,6 +73,14 @@ public:
     int result() const { return m_result; }
     void setResult(int result) { m_result = result; }
 
+    // the result is known without running the test
+    void setInferredResult(int result, const QString &report);
+    bool isInferred() const { return m_inferred; }
+
+    // no verdict explains the outcome: the test could not complete, or the client
+    // dropped the handshake without saying why
+    bool isUnexpectedResult() const;
+
     void setLocalCert(const QList<XSslCertificate> &chain) { m_localCertsChain = chain; }
     QList<XSslCertificate> localCert() const { return m_localCertsChain; }
 
@@ -68,30 +93,70 @@ public:
     void setSslCiphers(const QList<XSslCipher> ciphers) { m_sslCiphers = ciphers; }
     QList<XSslCipher> sslCiphers() const { return m_sslCiphers; }
 
+    void setClientAddress(const QString &addr) { m_clientAddress = addr; }
+    QString clientAddress() const { return m_clientAddress; }
+
+    void setClientHello(const SslClientHello &hello) { m_clientHello = hello; }
+    const SslClientHello &clientHello() const { return m_clientHello; }
+
+    // milliseconds from accepting the connection to the moment its outcome was known
+    void setVerdictTime(qint64 ms) { m_verdictTime = ms; }
+    qint64 verdictTime() const { return m_verdictTime; }
+
+    // where the time until the verdict was spent
+    void setPhaseTimings(const SslPhaseTimings &timings) { m_phaseTimings = timings; }
+    const SslPhaseTimings &phaseTimings() const { return m_phaseTimings; }
+    void markPhase(SslPhaseTimings::Phase phase) { m_phaseTimings.mark(phase); }
+
+    const QList<XSslError> &sslErrors() const { return m_sslErrors; }
+    const QList<QAbstractSocket::SocketError> &socketErrors() const { return m_socketErrors; }
+
     void addSslErrors(const QList<XSslError> errors) { m_sslErrors << errors; }
     void addSslErrorString(const QString error) { m_sslErrorsStr << error; }
     void addSocketErrors(const QList<QAbstractSocket::SocketError> errors) { m_socketErrors << errors; }
     void setSslConnectionStatus(bool isEstablished) { m_sslConnectionEstablished = isEstablished; }
     void addInterceptedData(const QByteArray &data) { m_interceptedData.append(data); }
 
-    const QByteArray &interceptedData() { return m_interceptedData; }
+    // alerts and failure reason of the handshake, the verdict is based on them
+    SslHandshakeLog &handshakeLog() { return m_handshakeLog; }
+    const SslHandshakeLog &handshakeLog() const { return m_handshakeLog; }
+
+    // only the beginning of intercepted data is kept in memory, see SslCapture
+    const QByteArray &interceptedData() const { return m_interceptedData.prefix(); }
+    qint64 interceptedDataSize() const { return m_interceptedData.size(); }
+
+protected:
+    virtual void copyPrepared(SslTest *test) const;
 
 private:
+    enum PrepareState {
+        NotPrepared,
+        Prepared,
+        PrepareFailed
+    };
+
     int m_id;
     QString m_name;
     QString m_description;
     int m_result;
+    bool m_inferred;
     QString m_report;
     QList<XSslCertificate> m_localCertsChain;
     XSslKey m_privateKey;
     XSsl::SslProtocol m_sslProtocol;
     QList<XSslCipher> m_sslCiphers;
+    PrepareState m_prepareState;
 
+    QString m_clientAddress;
+    SslClientHello m_clientHello;
+    qint64 m_verdictTime;
+    SslPhaseTimings m_phaseTimings;
     QList<XSslError> m_sslErrors;
     QStringList m_sslErrorsStr;
     QList<QAbstractSocket::SocketError> m_socketErrors;
     bool m_sslConnectionEstablished;
-    QByteArray m_interceptedData;
+    SslCapture m_interceptedData;
+    SslHandshakeLog m_handshakeLog;
 
     friend class SslCertificatesTest;
     friend class SslProtocolsTest;
@@ -109,14 +174,21 @@ class SslProtocolsTest : public SslTest
 public:
     virtual bool prepare(const SslUserSettings &settings);
     virtual void calcResults();
+    virtual bool isExcludedBy(const SslClientHello &hello) const;
     virtual bool setProtoAndCiphers() = 0;
     bool setProtoAndSupportedCiphers(XSsl::SslProtocol proto);
     bool setProtoAndExportCiphers(XSsl::SslProtocol proto);
     bool setProtoAndLowCiphers(XSsl::SslProtocol proto);
     bool setProtoAndMediumCiphers(XSsl::SslProtocol proto);
 
+protected:
+    virtual void copyPrepared(SslTest *test) const;
+
 private:
-    bool setProtoAndSpecifiedCiphers(XSsl::SslProtocol proto, QString ciphersString, QString name);
+    bool setProtoAndSpecifiedCiphers(XSsl::SslProtocol proto, SslCipherGrade grade, QString name);
+
+    // identifiers of the tested ciphers, empty if all supported ones are used
+    QVector<quint32> m_ciphersIds;
 
 };
 
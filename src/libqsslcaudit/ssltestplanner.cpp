@@ -0,0 +1,70 @@
+
+#include "ssltestplanner.h"
+
+#include <algorithm>
+
+
+static const struct {
+    int premise;
+    int implied;
+} implications[] = {
+    // a client refusing a protocol refuses it with weak ciphers as well
+    { 9, 10 }, { 9, 11 }, { 9, 12 },
+    { 13, 14 }, { 13, 15 }, { 13, 16 },
+    // a client refusing a certificate issued for its target domain refuses
+    // the same kind of certificate issued for another domain
+    { 2, 3 }, { 4, 5 }, { 6, 7 },
+};
+
+static const int implicationsCount = sizeof(implications) / sizeof(implications[0]);
+
+SslTestPlanner::SslTestPlanner()
+{
+}
+
+int SslTestPlanner::impliedCount(int id) const
+{
+    int ret = 0;
+
+    for (int i = 0; i < implicationsCount; i++) {
+        if (implications[i].premise == id)
+            ret++;
+    }
+
+    return ret;
+}
+
+QList<SslTest *> SslTestPlanner::order(const QList<SslTest *> &tests) const
+{
+    QList<SslTest *> ret = tests;
+
+    std::stable_sort(ret.begin(), ret.end(), [this](const SslTest *a, const SslTest *b) {
+        return impliedCount(a->id()) > impliedCount(b->id());
+    });
+
+    return ret;
+}
+
+void SslTestPlanner::reset()
+{
+    m_passedTests.clear();
+}
+
+void SslTestPlanner::addResult(const SslTest *test, bool passed)
+{
+    if (passed) {
+        m_passedTests.insert(test->id());
+    } else {
+        m_passedTests.remove(test->id());
+    }
+}
+
+int SslTestPlanner::implyingTest(const SslTest *test) const
+{
+    for (int i = 0; i < implicationsCount; i++) {
+        if ((implications[i].implied == test->id()) && m_passedTests.contains(implications[i].premise))
+            return implications[i].premise;
+    }
+
+    return 0;
+}
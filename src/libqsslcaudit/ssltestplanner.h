@@ -0,0 +1,36 @@
+#ifndef SSLTESTPLANNER_H
+#define SSLTESTPLANNER_H
+
+#include <QList>
+#include <QSet>
+
+#include "ssltest.h"
+
+
+// Knows which test results imply the results of other tests.
+// Tests deciding the most of other ones are run first, the rest keep their order.
+// A test is implied once one of the tests it depends on has passed: e.g., a client
+// refusing TLS 1.0 refuses TLS 1.0 with EXPORT ciphers too, thus there is no need
+// to wait for its connection.
+class SslTestPlanner
+{
+public:
+    SslTestPlanner();
+
+    QList<SslTest *> order(const QList<SslTest *> &tests) const;
+
+    // forgets results of the previous round
+    void reset();
+    void addResult(const SslTest *test, bool passed);
+
+    // id of a passed test which implies that the given one passes too, 0 if there is none
+    int implyingTest(const SslTest *test) const;
+
+private:
+    int impliedCount(int id) const;
+
+    QSet<int> m_passedTests;
+
+};
+
+#endif // SSLTESTPLANNER_H
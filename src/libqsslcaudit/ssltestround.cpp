@@ -0,0 +1,139 @@
+
+#include "ssltestround.h"
+
+
+SslTestRound::SslTestRound() :
+    workers(1),
+    currentTest(nullptr),
+    running(false),
+    acceptingDone(false),
+    expectedClients(0),
+    acceptedClients(0),
+    finishedClients(0),
+    pausedWorkers(0)
+{
+}
+
+SslTestRound::~SslTestRound()
+{
+    qDeleteAll(results);
+}
+
+void SslTestRound::setWorkersCount(int count)
+{
+    QMutexLocker locker(&mutex);
+    workers = count;
+}
+
+int SslTestRound::workersCount() const
+{
+    QMutexLocker locker(&mutex);
+    return workers;
+}
+
+void SslTestRound::start(SslTest *test, quint32 expectedClients)
+{
+    QMutexLocker locker(&mutex);
+
+    currentTest = test;
+    this->expectedClients = expectedClients;
+    acceptedClients = 0;
+    finishedClients = 0;
+    pausedWorkers = 0;
+    acceptingDone = false;
+    running = true;
+    qDeleteAll(results);
+    results.clear();
+
+    locker.unlock();
+
+    emit started();
+}
+
+SslTest *SslTestRound::test() const
+{
+    QMutexLocker locker(&mutex);
+    return currentTest;
+}
+
+QList<SslTest *> SslTestRound::takeResults()
+{
+    QMutexLocker locker(&mutex);
+    QList<SslTest *> ret = results;
+    results.clear();
+    return ret;
+}
+
+bool SslTestRound::addClient()
+{
+    QMutexLocker locker(&mutex);
+
+    if (!running)
+        return false;
+
+    // other workers may accept a few more clients before they pause, these are audited too
+    acceptedClients++;
+    bool full = !acceptingDone && (acceptedClients >= expectedClients);
+    if (full)
+        acceptingDone = true;
+
+    locker.unlock();
+
+    if (full)
+        emit acceptingFinished();
+
+    return true;
+}
+
+void SslTestRound::finishClient(SslTest *result)
+{
+    QMutexLocker locker(&mutex);
+
+    if (result)
+        results << result;
+
+    finishedClients++;
+    bool done = completeIfDone();
+
+    locker.unlock();
+
+    if (done)
+        emit finished();
+}
+
+void SslTestRound::stopAccepting()
+{
+    QMutexLocker locker(&mutex);
+
+    if (!running || acceptingDone)
+        return;
+
+    expectedClients = acceptedClients;
+    acceptingDone = true;
+
+    locker.unlock();
+
+    emit acceptingFinished();
+}
+
+void SslTestRound::workerPaused()
+{
+    QMutexLocker locker(&mutex);
+
+    pausedWorkers++;
+    bool done = completeIfDone();
+
+    locker.unlock();
+
+    if (done)
+        emit finished();
+}
+
+bool SslTestRound::completeIfDone()
+{
+    if (!running || !acceptingDone || (pausedWorkers < workers) || (finishedClients < acceptedClients))
+        return false;
+
+    running = false;
+    return true;
+}
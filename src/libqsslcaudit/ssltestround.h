@@ -0,0 +1,65 @@
+#ifndef SSLTESTROUND_H
+#define SSLTESTROUND_H
+
+#include <QObject>
+#include <QMutex>
+#include <QList>
+
+#include "ssltest.h"
+
+
+// Counts clients of the currently running test among all workers accepting connections.
+// Each worker has its own listener on the same port. Once the expected number of clients
+// is accepted, all workers are asked to pause accepting. The test is finished when every
+// worker has paused and all accepted clients are handled, thus no connection can slip
+// into the next test.
+// All methods are thread-safe, signals are emitted without holding the lock.
+class SslTestRound : public QObject
+{
+    Q_OBJECT
+
+public:
+    SslTestRound();
+    ~SslTestRound();
+
+    void setWorkersCount(int count);
+    int workersCount() const;
+
+    // called by the worker running the tests
+    void start(SslTest *test, quint32 expectedClients);
+    SslTest *test() const;
+    // per-connection results handed over by other workers
+    QList<SslTest *> takeResults();
+
+    // false if there is no running test, the connection has to be dropped
+    bool addClient();
+    // 'result' is the per-connection test context of another worker, the round takes it over
+    void finishClient(SslTest *result = nullptr);
+    // do not wait for more clients, complete the test once the accepted ones are handled
+    void stopAccepting();
+    // confirms that the worker does not accept connections anymore (see acceptingFinished())
+    void workerPaused();
+
+signals:
+    void started();
+    void acceptingFinished();
+    void finished();
+
+private:
+    // expects the lock to be held
+    bool completeIfDone();
+
+    mutable QMutex mutex;
+    int workers;
+    SslTest *currentTest;
+    bool running;
+    bool acceptingDone;
+    quint32 expectedClients;
+    quint32 acceptedClients;
+    quint32 finishedClients;
+    int pausedWorkers;
+    QList<SslTest *> results;
+
+};
+
+#endif // SSLTESTROUND_H
@@ -43,11 +43,11 @@ bool SslTest02::prepare(const SslUserSettings &settings)
     if (settings.getUserCN().length() != 0) {
         QString cn = settings.getUserCN();
 
-        cert = SslCertGen::genSignedCert(cn);
+        cert = SslCertGen::genSignedCert(cn, XSslKey(), settings.getCertKeyType());
     } else if (settings.getServerAddr().length() != 0) {
         XSslCertificate basecert = settings.getPeerCertificates().first();
 
-        cert = SslCertGen::genSignedCertFromTemplate(basecert);
+        cert = SslCertGen::genSignedCertFromTemplate(basecert, XSslKey(), settings.getCertKeyType());
     } else {
         return false;
     }
@@ -68,7 +68,7 @@ bool SslTest02::prepare(const SslUserSettings &settings)
 
 bool SslTest03::prepare(const SslUserSettings &settings)
 {
-    QPair<XSslCertificate, XSslKey> cert = SslCertGen::genSignedCert("www.example.com");
+    QPair<XSslCertificate, XSslKey> cert = SslCertGen::genSignedCert("www.example.com", XSslKey(), settings.getCertKeyType());
 
     QList<XSslCertificate> chain;
     chain << cert.first;
@@ -99,11 +99,11 @@ bool SslTest04::prepare(const SslUserSettings &settings)
     if (settings.getUserCN().length() != 0) {
         QString cn = settings.getUserCN();
 
-        generatedCert = SslCertGen::genSignedByCACert(cn, chain.at(0), key);
+        generatedCert = SslCertGen::genSignedByCACert(cn, chain.at(0), key, settings.getCertKeyType());
     } else if (settings.getServerAddr().length() != 0) {
         XSslCertificate basecert = settings.getPeerCertificates().first();
 
-        generatedCert = SslCertGen::genSignedByCACertFromTemplate(basecert, chain.at(0), key);
+        generatedCert = SslCertGen::genSignedByCACertFromTemplate(basecert, chain.at(0), key, settings.getCertKeyType());
     } else {
         return false;
     }
@@ -131,7 +131,7 @@ bool SslTest05::prepare(const SslUserSettings &settings)
     if (key.isNull())
         return false;
 
-    QPair<QList<XSslCertificate>, XSslKey> generatedCert = SslCertGen::genSignedByCACert("www.example.com", chain.at(0), key);
+    QPair<QList<XSslCertificate>, XSslKey> generatedCert = SslCertGen::genSignedByCACert("www.example.com", chain.at(0), key, settings.getCertKeyType());
 
     generatedCert.first << chain.mid(1); // create full chain of certificates (if user provided)
 
@@ -167,7 +167,7 @@ bool SslTest06::prepare(const SslUserSettings &settings)
         return false;
 
 
-    QPair<QList<XSslCertificate>, XSslKey> generatedCert = SslCertGen::genSignedByCACert(cn, chain.at(0), key);
+    QPair<QList<XSslCertificate>, XSslKey> generatedCert = SslCertGen::genSignedByCACert(cn, chain.at(0), key, settings.getCertKeyType());
 
     generatedCert.first << chain.mid(1); // create full chain of certificates (if user provided)
 
@@ -192,7 +192,7 @@ bool SslTest07::prepare(const SslUserSettings &settings)
     if (key.isNull())
         return false;
 
-    QPair<QList<XSslCertificate>, XSslKey> generatedCert = SslCertGen::genSignedByCACert("www.example.com", chain.at(0), key);
+    QPair<QList<XSslCertificate>, XSslKey> generatedCert = SslCertGen::genSignedByCACert("www.example.com", chain.at(0), key, settings.getCertKeyType());
 
     generatedCert.first << chain.mid(1); // create full chain of certificates (if user provided)
 
@@ -295,3 +295,19 @@ bool SslTest22::setProtoAndCiphers()
 {
     return setProtoAndMediumCiphers(XSsl::TlsV1_2);
 }
+
+
+SslTest *SslCipherProbeTest::clone() const
+{
+    SslCipherProbeTest *test = new SslCipherProbeTest(m_protocol);
+
+    copyPrepared(test);
+
+    return test;
+}
+
+bool SslCipherProbeTest::setProtoAndCiphers()
+{
+    // ciphers are replaced before every probe
+    return setProtoAndSupportedCiphers(m_protocol);
+}
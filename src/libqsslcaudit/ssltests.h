@@ -269,4 +269,21 @@ public:
 
 };
 
+// not a regular test: offers a given set of ciphers, see SslCAudit::runCipherEnumeration()
+class SslCipherProbeTest : public SslProtocolsTest
+{
+public:
+    SslCipherProbeTest(XSsl::SslProtocol protocol) : m_protocol(protocol) {
+        setId(0);
+        setName("accepted ciphers enumeration");
+        setDescription("test for ciphers accepted by client");
+    }
+    SslTest *clone() const;
+    bool setProtoAndCiphers();
+
+private:
+    XSsl::SslProtocol m_protocol;
+
+};
+
 #endif // SSLTESTS_H
@@ -0,0 +1,132 @@
+#include "ssltranscript.h"
+#include "ssltest.h"
+#include "debug.h"
+
+#include <QDir>
+#include <QTemporaryFile>
+#include <QTextStream>
+
+
+QString SslTranscript::transcriptDirectory;
+
+void SslTranscript::setDirectory(const QString &path)
+{
+#ifdef UNSAFE
+    if (!QDir().mkpath(path)) {
+        RED("can not create transcript directory " + path);
+        return;
+    }
+
+    transcriptDirectory = path;
+    XSslSocket::setHandshakeTranscriptSize(bufferSize);
+#else
+    Q_UNUSED(path);
+    RED("handshake transcripts are only recorded with the unsafe SSL library");
+#endif
+}
+
+QString SslTranscript::directory()
+{
+    return transcriptDirectory;
+}
+
+#ifdef UNSAFE
+static QString contentTypeName(quint8 type)
+{
+    switch (type) {
+    case 20:
+        return "ChangeCipherSpec";
+    case 21:
+        return "Alert";
+    case 22:
+        return "Handshake";
+    }
+    return QString("content type %1").arg(type);
+}
+
+static QString handshakeTypeName(quint8 type)
+{
+    switch (type) {
+    case 0:
+        return "HelloRequest";
+    case 1:
+        return "ClientHello";
+    case 2:
+        return "ServerHello";
+    case 4:
+        return "NewSessionTicket";
+    case 8:
+        return "EncryptedExtensions";
+    case 11:
+        return "Certificate";
+    case 12:
+        return "ServerKeyExchange";
+    case 13:
+        return "CertificateRequest";
+    case 14:
+        return "ServerHelloDone";
+    case 15:
+        return "CertificateVerify";
+    case 16:
+        return "ClientKeyExchange";
+    case 20:
+        return "Finished";
+    }
+    return QString("type %1").arg(type);
+}
+
+QString SslTranscript::save(const SslTest *test, const QVector<SslUnsafeHandshakeRecord> &records)
+{
+    if (transcriptDirectory.isEmpty())
+        return QString();
+
+    QTemporaryFile file(QDir(transcriptDirectory).filePath(QString("transcript-test%1-XXXXXX.txt").arg(test->id())));
+    file.setAutoRemove(false);
+
+    if (!file.open()) {
+        RED("can not create transcript file in " + transcriptDirectory);
+        return QString();
+    }
+
+    QTextStream out(&file);
+
+    out << "test: " << test->id() << " (" << test->name() << ")\n";
+    out << "client: " << test->clientAddress() << "\n";
+    out << "result: " << test->result() << ", " << test->report() << "\n";
+    if (test->clientHello().isValid())
+        out << "ClientHello fingerprint: " << test->clientHello().fingerprint() << "\n";
+    out << "\n";
+
+    if (records.isEmpty())
+        out << "no handshake records\n";
+
+    for (int i = 0; i < records.size(); i++) {
+        const SslUnsafeHandshakeRecord &record = records.at(i);
+
+        QString message = contentTypeName(record.contentType);
+        if (!record.data.isEmpty()) {
+            if (record.contentType == 22) {
+                message += " " + handshakeTypeName(quint8(record.data.at(0)));
+            } else if ((record.contentType == 21) && (record.data.size() >= 2)) {
+                message += QString(" level %1 description %2").arg(quint8(record.data.at(0))).arg(quint8(record.data.at(1)));
+            }
+        }
+
+        out << QString("%1 ms %2 %3, version 0x%4, %5 bytes")
+               .arg(record.timestamp / 1000000.0, 10, 'f', 3)
+               .arg(record.sent ? "sent    " : "received")
+               .arg(message)
+               .arg(record.version, 4, 16, QChar('0'))
+               .arg(record.size);
+        if (record.data.size() < record.size)
+            out << QString(" (first %1 kept)").arg(record.data.size());
+        out << "\n";
+
+        for (int pos = 0; pos < record.data.size(); pos += 16)
+            out << "    " << record.data.mid(pos, 16).toHex() << "\n";
+    }
+
+    out.flush();
+    return file.fileName();
+}
+#endif
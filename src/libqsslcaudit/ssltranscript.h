@@ -0,0 +1,37 @@
+#ifndef SSLTRANSCRIPT_H
+#define SSLTRANSCRIPT_H
+
+#include <QString>
+#include <QVector>
+
+#ifdef UNSAFE
+#include "sslunsafesocket.h"
+#endif
+
+class SslTest;
+
+
+// Handshake transcripts of connections whose tests ended in an unexpected state.
+// Once a directory is set, the SSL library records every handshake into a
+// ring buffer of bufferSize bytes per connection; the records are only
+// decoded and written when a transcript is saved.
+class SslTranscript
+{
+public:
+    static void setDirectory(const QString &path);
+    static QString directory();
+    static bool isEnabled() { return !transcriptDirectory.isEmpty(); }
+
+#ifdef UNSAFE
+    // returns the path of the written file or an empty string on failure
+    static QString save(const SslTest *test, const QVector<SslUnsafeHandshakeRecord> &records);
+#endif
+
+    static const int bufferSize = 64 * 1024;
+
+private:
+    static QString transcriptDirectory;
+
+};
+
+#endif // SSLTRANSCRIPT_H
@@ -26,6 +26,21 @@ SslUserSettings::SslUserSettings()
     startTlsProtocol = SslServer::StartTlsUnknownProtocol;
     loopTests = false;
     waitDataTimeout = 5000;
+    clientsCount = 1;
+    workersCount = 1;
+    keyPoolDepth = 4;
+    certCacheDir = "";
+    certKeyType = SslCertGen::KeyRsa;
+    captureLimit = 4096;
+    captureDir = "";
+    inferFromClientHello = false;
+    adaptiveTests = false;
+    resultCacheDir = "";
+    enumCiphersProtocol = XSsl::UnknownProtocol;
+    startupProfile = false;
+    transcriptDir = "";
+    resultsFile = "";
+    resultsFormat = SslResultStream::JsonLines;
 }
 
 void SslUserSettings::setListenAddress(const QHostAddress &addr)
@@ -257,3 +272,168 @@ quint32 SslUserSettings::getWaitDataTimeout() const
 {
     return waitDataTimeout;
 }
+
+void SslUserSettings::setClientsCount(quint32 count)
+{
+    clientsCount = count;
+}
+
+quint32 SslUserSettings::getClientsCount() const
+{
+    return clientsCount;
+}
+
+void SslUserSettings::setWorkersCount(quint32 count)
+{
+    workersCount = count;
+}
+
+quint32 SslUserSettings::getWorkersCount() const
+{
+    return workersCount;
+}
+
+void SslUserSettings::setKeyPoolDepth(int depth)
+{
+    keyPoolDepth = depth;
+}
+
+int SslUserSettings::getKeyPoolDepth() const
+{
+    return keyPoolDepth;
+}
+
+void SslUserSettings::setCertCacheDir(const QString &dir)
+{
+    certCacheDir = dir;
+}
+
+QString SslUserSettings::getCertCacheDir() const
+{
+    return certCacheDir;
+}
+
+void SslUserSettings::setCertKeyType(SslCertGen::KeyType type)
+{
+    certKeyType = type;
+}
+
+SslCertGen::KeyType SslUserSettings::getCertKeyType() const
+{
+    return certKeyType;
+}
+
+void SslUserSettings::setCaptureLimit(qint64 limit)
+{
+    captureLimit = limit;
+}
+
+qint64 SslUserSettings::getCaptureLimit() const
+{
+    return captureLimit;
+}
+
+void SslUserSettings::setCaptureDir(const QString &dir)
+{
+    captureDir = dir;
+}
+
+QString SslUserSettings::getCaptureDir() const
+{
+    return captureDir;
+}
+
+void SslUserSettings::setInferFromClientHello(bool infer)
+{
+    inferFromClientHello = infer;
+}
+
+bool SslUserSettings::getInferFromClientHello() const
+{
+    return inferFromClientHello;
+}
+
+void SslUserSettings::setAdaptiveTests(bool adaptive)
+{
+    adaptiveTests = adaptive;
+}
+
+bool SslUserSettings::getAdaptiveTests() const
+{
+    return adaptiveTests;
+}
+
+void SslUserSettings::setResultCacheDir(const QString &dir)
+{
+    resultCacheDir = dir;
+}
+
+QString SslUserSettings::getResultCacheDir() const
+{
+    return resultCacheDir;
+}
+
+bool SslUserSettings::setEnumCiphersProtocol(const QString &proto)
+{
+    if (proto == QString("ssl2")) {
+        enumCiphersProtocol = XSsl::SslV2;
+    } else if (proto == QString("ssl3")) {
+        enumCiphersProtocol = XSsl::SslV3;
+    } else if (proto == QString("tls1.0")) {
+        enumCiphersProtocol = XSsl::TlsV1_0;
+    } else if (proto == QString("tls1.1")) {
+        enumCiphersProtocol = XSsl::TlsV1_1;
+    } else if (proto == QString("tls1.2")) {
+        enumCiphersProtocol = XSsl::TlsV1_2;
+    } else {
+        enumCiphersProtocol = XSsl::UnknownProtocol;
+        return false;
+    }
+
+    return true;
+}
+
+XSsl::SslProtocol SslUserSettings::getEnumCiphersProtocol() const
+{
+    return enumCiphersProtocol;
+}
+
+void SslUserSettings::setStartupProfile(bool profile)
+{
+    startupProfile = profile;
+}
+
+bool SslUserSettings::getStartupProfile() const
+{
+    return startupProfile;
+}
+
+void SslUserSettings::setTranscriptDir(const QString &dir)
+{
+    transcriptDir = dir;
+}
+
+QString SslUserSettings::getTranscriptDir() const
+{
+    return transcriptDir;
+}
+
+void SslUserSettings::setResultsFile(const QString &path)
+{
+    resultsFile = path;
+}
+
+QString SslUserSettings::getResultsFile() const
+{
+    return resultsFile;
+}
+
+bool SslUserSettings::setResultsFormat(const QString &format)
+{
+    return SslResultStream::formatFromName(format, &resultsFormat);
+}
+
+SslResultStream::Format SslUserSettings::getResultsFormat() const
+{
+    return resultsFormat;
+}
@@ -4,6 +4,8 @@
 #include <QHostAddress>
 
 #include "sslserver.h"
+#include "sslcertgen.h"
+#include "sslresultstream.h"
 
 #ifdef UNSAFE
 #include "sslunsafecertificate.h"
@@ -60,6 +62,51 @@ public:
     void setWaitDataTimeout(quint32 to);
     quint32 getWaitDataTimeout() const;
 
+    void setClientsCount(quint32 count);
+    quint32 getClientsCount() const;
+
+    void setWorkersCount(quint32 count);
+    quint32 getWorkersCount() const;
+
+    void setKeyPoolDepth(int depth);
+    int getKeyPoolDepth() const;
+
+    void setCertCacheDir(const QString &dir);
+    QString getCertCacheDir() const;
+
+    void setCertKeyType(SslCertGen::KeyType type);
+    SslCertGen::KeyType getCertKeyType() const;
+
+    void setCaptureLimit(qint64 limit);
+    qint64 getCaptureLimit() const;
+
+    void setCaptureDir(const QString &dir);
+    QString getCaptureDir() const;
+
+    void setInferFromClientHello(bool infer);
+    bool getInferFromClientHello() const;
+
+    void setAdaptiveTests(bool adaptive);
+    bool getAdaptiveTests() const;
+
+    void setResultCacheDir(const QString &dir);
+    QString getResultCacheDir() const;
+
+    bool setEnumCiphersProtocol(const QString &proto);
+    XSsl::SslProtocol getEnumCiphersProtocol() const;
+
+    void setStartupProfile(bool profile);
+    bool getStartupProfile() const;
+
+    void setTranscriptDir(const QString &dir);
+    QString getTranscriptDir() const;
+
+    void setResultsFile(const QString &path);
+    QString getResultsFile() const;
+
+    bool setResultsFormat(const QString &format);
+    SslResultStream::Format getResultsFormat() const;
+
 private:
     QHostAddress listenAddress;
     quint16 listenPort;
@@ -74,6 +121,21 @@ private:
     SslServer::StartTlsProtocol startTlsProtocol;
     bool loopTests;
     quint32 waitDataTimeout;
+    quint32 clientsCount;
+    quint32 workersCount;
+    int keyPoolDepth;
+    QString certCacheDir;
+    SslCertGen::KeyType certKeyType;
+    qint64 captureLimit;
+    QString captureDir;
+    bool inferFromClientHello;
+    bool adaptiveTests;
+    QString resultCacheDir;
+    XSsl::SslProtocol enumCiphersProtocol;
+    bool startupProfile;
+    QString transcriptDir;
+    QString resultsFile;
+    SslResultStream::Format resultsFormat;
 
 };
 
@@ -3,12 +3,23 @@
 #include "sslusersettings.h"
 #include "ssltests.h"
 #include "sslcaudit.h"
+#include "sslkeypool.h"
+#include "sslcertcache.h"
+#include "sslresultcache.h"
+#include "sslcapture.h"
+#include "sslstartupprofile.h"
+#include "ssltranscript.h"
+#include "sslresultstream.h"
 
 #include <QCoreApplication>
 #include <QCommandLineParser>
 #include <QThread>
 #include <QHostAddress>
 
+#ifdef UNSAFE
+#include "sslunsafesocket.h"
+#endif
+
 
 static QList<int> selectedTests;
 
@@ -74,9 +85,67 @@ void parseOptions(const QCoreApplication &a, SslUserSettings *settings)
     QCommandLineOption waitDataTimeoutOption(QStringList() << "w" << "wait-data-timeout",
                                         "wait for incoming data <ms> milliseconds before emitting error", "5000");
     parser.addOption(waitDataTimeoutOption);
+    QCommandLineOption clientsOption(QStringList() << "clients",
+                                     "audit <n> clients simultaneously, each test completes once all of them were handled", "1");
+    parser.addOption(clientsOption);
+    QCommandLineOption workersOption(QStringList() << "workers",
+                                     "accept connections in <n> threads sharing the listening port (0 starts one per CPU core)", "1");
+    parser.addOption(workersOption);
+    QCommandLineOption keyPoolDepthOption(QStringList() << "key-pool-depth",
+                                          "keep <n> private keys generated in background (0 disables the pool)", "4");
+    parser.addOption(keyPoolDepthOption);
+    QCommandLineOption certCacheOption(QStringList() << "cert-cache",
+                                       "reuse generated certificates stored in <dir> between runs", "dir");
+    parser.addOption(certCacheOption);
+    QCommandLineOption certKeyTypeOption(QStringList() << "cert-key-type",
+                                         "type of keys generated for certificate tests: rsa, ec256 or ec384", "rsa");
+    parser.addOption(certKeyTypeOption);
+    QCommandLineOption captureLimitOption(QStringList() << "capture-limit",
+                                          "keep the first <bytes> of intercepted data per connection in memory", "4096");
+    parser.addOption(captureLimitOption);
+    QCommandLineOption captureDirOption(QStringList() << "capture-dir",
+                                        "save intercepted data exceeding the capture limit to files in <dir>", "dir");
+    parser.addOption(captureDirOption);
+    QCommandLineOption inferFromHelloOption(QStringList() << "infer-from-hello",
+                                            "do not run protocol tests which the client excludes by its ClientHello");
+    parser.addOption(inferFromHelloOption);
+    QCommandLineOption adaptiveTestsOption(QStringList() << "adaptive-tests",
+                                           "run tests deciding other ones first, do not run tests implied by their results");
+    parser.addOption(adaptiveTestsOption);
+    QCommandLineOption resultCacheOption(QStringList() << "result-cache",
+                                         "keep test results of every client build (ClientHello fingerprint) in <dir> and reuse them", "dir");
+    parser.addOption(resultCacheOption);
+    QCommandLineOption enumCiphersOption(QStringList() << "enum-ciphers",
+                                         "instead of running tests, find ciphers the client accepts with <protocol>", "ssl2|ssl3|tls1.0|tls1.1|tls1.2");
+    parser.addOption(enumCiphersOption);
+    QCommandLineOption startupProfileOption(QStringList() << "startup-profile",
+                                            "report time spent in each startup phase until listening for clients");
+    parser.addOption(startupProfileOption);
+    QCommandLineOption transcriptDirOption(QStringList() << "transcript-dir",
+                                           "record handshakes and save those of tests ending in an unexpected state to <dir>", "dir");
+    parser.addOption(transcriptDirOption);
+    QCommandLineOption resultsFileOption(QStringList() << "results-file",
+                                         "append a record for each completed test to <file> (- for standard output)", "file");
+    parser.addOption(resultsFileOption);
+    QCommandLineOption resultsFormatOption(QStringList() << "results-format",
+                                           "format of the results file: jsonl (JSON Lines) or csv", "jsonl");
+    parser.addOption(resultsFormatOption);
+    QCommandLineOption logLevelOption(QStringList() << "log-level",
+                                      "print only messages of this level and above: debug, verbose, info or error", "debug");
+    parser.addOption(logLevelOption);
 
     parser.process(a);
 
+    // applied first, other options already print messages
+    if (parser.isSet(logLevelOption)) {
+        SslLog::Level level;
+        if (!SslLog::levelFromName(parser.value(logLevelOption), &level)) {
+            RED("unsupported log level " + parser.value(logLevelOption));
+            exit(-1);
+        }
+        SslLog::setLevel(level);
+    }
+
     if (parser.isSet(showciphersOption)) {
         SslCAudit::showCiphers();
         exit(0);
@@ -192,23 +261,103 @@ void parseOptions(const QCoreApplication &a, SslUserSettings *settings)
         if (ok)
             settings->setWaitDataTimeout(to);
     }
+    if (parser.isSet(clientsOption)) {
+        bool ok = true;
+        quint32 count = parser.value(clientsOption).toUInt(&ok);
+        if (!ok || (count == 0)) {
+            RED("invalid number of clients");
+            exit(-1);
+        }
+        settings->setClientsCount(count);
+    }
+    if (parser.isSet(workersOption)) {
+        bool ok = true;
+        quint32 count = parser.value(workersOption).toUInt(&ok);
+        if (!ok) {
+            RED("invalid number of workers");
+            exit(-1);
+        }
+        if (count == 0)
+            count = qMax(QThread::idealThreadCount(), 1);
+        settings->setWorkersCount(count);
+    }
+    if (parser.isSet(keyPoolDepthOption)) {
+        bool ok = true;
+        int depth = parser.value(keyPoolDepthOption).toInt(&ok);
+        if (!ok || (depth < 0)) {
+            RED("invalid key pool depth");
+            exit(-1);
+        }
+        settings->setKeyPoolDepth(depth);
+    }
+    if (parser.isSet(certCacheOption)) {
+        settings->setCertCacheDir(parser.value(certCacheOption));
+    }
+    if (parser.isSet(certKeyTypeOption)) {
+        SslCertGen::KeyType keyType;
+        if (!SslCertGen::keyTypeFromName(parser.value(certKeyTypeOption), &keyType)) {
+            RED("unsupported key type " + parser.value(certKeyTypeOption));
+            exit(-1);
+        }
+        settings->setCertKeyType(keyType);
+    }
+    if (parser.isSet(captureLimitOption)) {
+        bool ok = true;
+        qint64 limit = parser.value(captureLimitOption).toLongLong(&ok);
+        if (!ok || (limit < 0)) {
+            RED("invalid capture limit");
+            exit(-1);
+        }
+        settings->setCaptureLimit(limit);
+    }
+    if (parser.isSet(captureDirOption)) {
+        settings->setCaptureDir(parser.value(captureDirOption));
+    }
+    if (parser.isSet(inferFromHelloOption)) {
+        settings->setInferFromClientHello(true);
+    }
+    if (parser.isSet(adaptiveTestsOption)) {
+        settings->setAdaptiveTests(true);
+    }
+    if (parser.isSet(resultCacheOption)) {
+        settings->setResultCacheDir(parser.value(resultCacheOption));
+    }
+    if (parser.isSet(enumCiphersOption)) {
+        if (!settings->setEnumCiphersProtocol(parser.value(enumCiphersOption))) {
+            RED("unsupported protocol for ciphers enumeration");
+            exit(-1);
+        }
+        if ((settings->getClientsCount() > 1) || (settings->getWorkersCount() > 1)) {
+            RED("ciphers enumeration audits one client at a time");
+            exit(-1);
+        }
+    }
+    if (parser.isSet(startupProfileOption)) {
+        settings->setStartupProfile(true);
+    }
+    if (parser.isSet(transcriptDirOption)) {
+        settings->setTranscriptDir(parser.value(transcriptDirOption));
+    }
+    if (parser.isSet(resultsFileOption)) {
+        settings->setResultsFile(parser.value(resultsFileOption));
+    }
+    if (parser.isSet(resultsFormatOption)) {
+        if (!settings->setResultsFormat(parser.value(resultsFormatOption))) {
+            RED("unsupported results format " + parser.value(resultsFormatOption));
+            exit(-1);
+        }
+    }
 }
 
 
-QList<SslTest *> prepareSslTests(const SslUserSettings &settings)
+QList<SslTest *> createSslTests()
 {
     QList<SslTest *> ret;
 
-    VERBOSE("preparing selected tests...");
+    // tests are prepared by SslCAudit right before they are run
     for (int i = 0; i < selectedTests.size(); i++) {
-        SslTest *test = SslTest::createTest(selectedTests.at(i));
-        if (test->prepare(settings)) {
-            ret << test;
-        } else {
-            VERBOSE("\tskipping test: " + test->description());
-        }
+        ret << SslTest::createTest(selectedTests.at(i));
     }
-    VERBOSE("");
 
     return ret;
 }
@@ -216,17 +365,58 @@ QList<SslTest *> prepareSslTests(const SslUserSettings &settings)
 
 int main(int argc, char *argv[])
 {
+    // phases are always recorded, they are only reported with --startup-profile
+    SslStartupProfile::start();
+
     QCoreApplication a(argc, argv);
     QCoreApplication::setApplicationName("qsslcaudit");
     QCoreApplication::setApplicationVersion(QSSLC_VERSION);
     QCoreApplication::setOrganizationName("Gremwell");
     QCoreApplication::setOrganizationDomain("gremwell.com");
 
+#ifdef UNSAFE
+    // the tool acts as a server, system CA certificates are only loaded if a client
+    // connection needs them (see SslUserSettings::setServerAddr())
+    XSslSocket::setServerOnlyInitialization(true);
+#endif
+
     SslUserSettings settings;
 
     parseOptions(a, &settings);
 
-    QList<SslTest *> sslTests = prepareSslTests(settings);
+    SslStartupProfile::addPhase("options parsed");
+
+    if (!settings.getCertCacheDir().isEmpty())
+        SslCertCache::setDirectory(settings.getCertCacheDir());
+
+    if (!settings.getResultCacheDir().isEmpty()) {
+        SslResultCache::setDirectory(settings.getResultCacheDir());
+        SslResultCache::setSettings(settings);
+    }
+
+    SslCapture::setMemoryLimit(settings.getCaptureLimit());
+    if (!settings.getCaptureDir().isEmpty())
+        SslCapture::setSpillDirectory(settings.getCaptureDir());
+
+    if (!settings.getTranscriptDir().isEmpty())
+        SslTranscript::setDirectory(settings.getTranscriptDir());
+
+    if (!settings.getResultsFile().isEmpty()
+            && !SslResultStream::open(settings.getResultsFile(), settings.getResultsFormat()))
+        return -1;
+
+    // keys are generated in background while tests are being run
+    SslKeyPool *keyPool = SslKeyPool::instance();
+    if (settings.getKeyPoolDepth() > 0) {
+        keyPool->setDepth(settings.getKeyPoolDepth());
+        keyPool->start(QThread::LowPriority);
+    }
+
+    SslStartupProfile::addPhase("caches and key pool set up");
+
+    QList<SslTest *> sslTests = createSslTests();
+
+    SslStartupProfile::addPhase("tests created");
 
     QThread *thread = new QThread;
     SslCAudit *caudit = new SslCAudit(settings);
@@ -238,10 +428,30 @@ int main(int argc, char *argv[])
 
     QObject::connect(caudit, &SslCAudit::sslTestsFinished, [=](){
         caudit->printSummary();
+        SslLog::flush();
         qApp->exit();
     });
 
+    // other workers only accept connections for the tests run by the first one
+    for (quint32 i = 1; i < settings.getWorkersCount(); i++) {
+        QThread *workerThread = new QThread;
+        SslCAudit *worker = new SslCAudit(settings);
+
+        caudit->addWorker(worker);
+        worker->moveToThread(workerThread);
+        QObject::connect(workerThread, SIGNAL(started()), worker, SLOT(run()));
+        QObject::connect(workerThread, SIGNAL(finished()), workerThread, SLOT(deleteLater()));
+
+        workerThread->start();
+    }
+
     thread->start();
 
-    return a.exec();
+    SslStartupProfile::addPhase("audit threads started");
+
+    int ret = a.exec();
+
+    keyPool->stop();
+
+    return ret;
 }
@@ -125,9 +125,8 @@ SslUnsafeCipher::SslUnsafeCipher(const QString &name, SslUnsafe::SslProtocol pro
     Constructs an identical copy of the \a other cipher.
 */
 SslUnsafeCipher::SslUnsafeCipher(const SslUnsafeCipher &other)
-    : d(new SslUnsafeCipherPrivate)
+    : d(other.d)
 {
-    *d.data() = *other.d.data();
 }
 
 /*!
@@ -143,7 +142,7 @@ SslUnsafeCipher::~SslUnsafeCipher()
 */
 SslUnsafeCipher &SslUnsafeCipher::operator=(const SslUnsafeCipher &other)
 {
-    *d.data() = *other.d.data();
+    d = other.d;
     return *this;
 }
 
@@ -43,7 +43,7 @@
 
 #include "sslunsafenetworkglobal.h"
 #include <QtCore/qstring.h>
-#include <QtCore/qscopedpointer.h>
+#include <QtCore/qshareddata.h>
 #include "sslunsafe.h"
 
 QT_BEGIN_NAMESPACE
@@ -83,7 +83,8 @@ public:
     SslUnsafe::SslProtocol protocol() const;
 
 private:
-    QScopedPointer<SslUnsafeCipherPrivate> d;
+    // implicitly shared, copies of the ciphers cached by the backend do not allocate
+    QSharedDataPointer<SslUnsafeCipherPrivate> d;
     friend class SslUnsafeSocketBackendPrivate;
 };
 
@@ -55,7 +55,7 @@ QT_BEGIN_NAMESPACE
 // We mean it.
 //
 
-class SslUnsafeCipherPrivate
+class SslUnsafeCipherPrivate : public QSharedData
 {
 public:
     SslUnsafeCipherPrivate()
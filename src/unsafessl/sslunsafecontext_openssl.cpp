@@ -46,11 +46,52 @@
 #include "sslunsafecontext_openssl_p.h"
 #include "sslunsafesocket_openssl_p.h"
 #include "sslunsafesocket_openssl_symbols_p.h"
+#include "sslunsafediffiehellmanparameters_p.h"
+
+#include <QtCore/qcache.h>
+#include <QtCore/qcryptographichash.h>
+#include <QtCore/qdatastream.h>
+#include <QtCore/qmutex.h>
 
 QT_BEGIN_NAMESPACE
 
+// contexts still referenced by sockets survive dropping them from the cache
+static const int sslContextCacheMaxSize = 64;
+
+// Server contexts built from identical configurations are shared between
+// sockets: only SSL_new() is left for each accepted connection.
+// The least recently used context is dropped once the cache is full.
+struct SslUnsafeContextCache
+{
+    SslUnsafeContextCache() : contexts(sslContextCacheMaxSize), hits(0), misses(0) {}
+
+    QMutex mutex;
+    QCache<QByteArray, QSharedPointer<SslUnsafeContext> > contexts;
+    quint64 hits;
+    quint64 misses;
+};
+
+Q_GLOBAL_STATIC(SslUnsafeContextCache, sslContextCache)
+
+// DER encoding of a key only known by its handle, empty if it can not be exported
+// (e.g., the key is kept by an engine)
+static QByteArray opaqueKeyToDer(EVP_PKEY *pkey)
+{
+    const int length = q_i2d_PrivateKey(pkey, nullptr);
+    if (length <= 0)
+        return QByteArray();
+
+    QByteArray der(length, Qt::Uninitialized);
+    unsigned char *data = reinterpret_cast<unsigned char *>(der.data());
+    if (q_i2d_PrivateKey(pkey, &data) != length)
+        return QByteArray();
+
+    return der;
+}
+
 SslUnsafeContext::SslUnsafeContext()
-    : ctx(0),
+    : sslMode(SslUnsafeSocket::UnencryptedMode),
+    ctx(0),
     pkey(0),
     session(0),
     m_sessionTicketLifeTimeHint(-1)
@@ -73,6 +114,7 @@ SslUnsafeContext::~SslUnsafeContext()
 SslUnsafeContext* SslUnsafeContext::fromConfiguration(SslUnsafeSocket::SslMode mode, const SslUnsafeConfiguration &configuration, bool allowRootCertOnDemandLoading)
 {
     SslUnsafeContext *sslContext = new SslUnsafeContext();
+    sslContext->sslMode = mode;
     initSslContext(sslContext, mode, configuration, allowRootCertOnDemandLoading);
     return sslContext;
 }
@@ -80,10 +122,105 @@ SslUnsafeContext* SslUnsafeContext::fromConfiguration(SslUnsafeSocket::SslMode m
 QSharedPointer<SslUnsafeContext> SslUnsafeContext::sharedFromConfiguration(SslUnsafeSocket::SslMode mode, const SslUnsafeConfiguration &configuration, bool allowRootCertOnDemandLoading)
 {
     QSharedPointer<SslUnsafeContext> sslContext = QSharedPointer<SslUnsafeContext>::create();
+    sslContext->sslMode = mode;
     initSslContext(sslContext.data(), mode, configuration, allowRootCertOnDemandLoading);
     return sslContext;
 }
 
+QByteArray SslUnsafeContext::cacheKey(SslUnsafeSocket::SslMode mode, const SslUnsafeConfiguration &configuration, bool allowRootCertOnDemandLoading)
+{
+    const SslUnsafeConfigurationPrivate *d = configuration.d.constData();
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    QByteArray scalars;
+
+    // everything initSslContext() takes into account
+    QDataStream stream(&scalars, QIODevice::WriteOnly);
+    stream << int(mode) << int(d->protocol) << int(d->sslOptions) << int(d->peerVerifyMode)
+           << d->peerVerifyDepth << allowRootCertOnDemandLoading << int(d->privateKey.algorithm());
+    hash.addData(scalars);
+
+    for (const SslUnsafeCipher &cipher : d->ciphers)
+        hash.addData(cipher.name().toLatin1() + ':');
+    hash.addData("|", 1);
+    for (const SslUnsafeCertificate &cert : d->localCertificateChain)
+        hash.addData(cert.toDer());
+    hash.addData("|", 1);
+    if (d->privateKey.algorithm() == SslUnsafe::Opaque) {
+        // the same key may be wrapped by several handles, and a handle may be reused for another key
+        const QByteArray der = opaqueKeyToDer(reinterpret_cast<EVP_PKEY *>(d->privateKey.handle()));
+        if (der.isEmpty())
+            return QByteArray();
+        hash.addData(der);
+    } else {
+        hash.addData(d->privateKey.toDer());
+    }
+    hash.addData("|", 1);
+    for (const SslUnsafeCertificate &cert : d->caCertificates)
+        hash.addData(cert.toDer());
+    hash.addData("|", 1);
+    for (const SslUnsafeEllipticCurve &curve : d->ellipticCurves)
+        hash.addData(reinterpret_cast<const char *>(&curve.id), sizeof(curve.id));
+    hash.addData("|", 1);
+    hash.addData(d->dhParams.d->derData);
+    hash.addData("|", 1);
+    hash.addData(d->preSharedKeyIdentityHint);
+
+    return hash.result();
+}
+
+QSharedPointer<SslUnsafeContext> SslUnsafeContext::cachedFromConfiguration(SslUnsafeSocket::SslMode mode, const SslUnsafeConfiguration &configuration, bool allowRootCertOnDemandLoading)
+{
+    // client contexts keep the session to resume and NPN state, do not share them
+    if (mode != SslUnsafeSocket::SslServerMode
+            || !configuration.d->nextAllowedProtocols.isEmpty()
+            || !configuration.sessionTicket().isEmpty())
+        return sharedFromConfiguration(mode, configuration, allowRootCertOnDemandLoading);
+
+    const QByteArray key = cacheKey(mode, configuration, allowRootCertOnDemandLoading);
+    // a key which can not be told apart from others by its contents is not shared
+    if (key.isEmpty())
+        return sharedFromConfiguration(mode, configuration, allowRootCertOnDemandLoading);
+
+    SslUnsafeContextCache *cache = sslContextCache();
+
+    {
+        QMutexLocker locker(&cache->mutex);
+        // marks the context as the most recently used one
+        QSharedPointer<SslUnsafeContext> *sslContext = cache->contexts.object(key);
+        if (sslContext) {
+            cache->hits++;
+            return *sslContext;
+        }
+        cache->misses++;
+    }
+
+    QSharedPointer<SslUnsafeContext> sslContext = sharedFromConfiguration(mode, configuration, allowRootCertOnDemandLoading);
+    if (sslContext->error() != SslUnsafeError::NoError)
+        return sslContext;
+
+    // every audited connection has to go through the full handshake,
+    // so neither the session cache nor tickets may outlive a single connection
+    q_SSL_CTX_ctrl(sslContext->ctx, SSL_CTRL_SET_SESS_CACHE_MODE, SSL_SESS_CACHE_OFF, NULL);
+    q_SSL_CTX_set_options(sslContext->ctx, SSL_OP_NO_TICKET);
+
+    QMutexLocker locker(&cache->mutex);
+    cache->contexts.insert(key, new QSharedPointer<SslUnsafeContext>(sslContext));
+
+    return sslContext;
+}
+
+quint64 SslUnsafeContext::cacheHits()
+{
+    QMutexLocker locker(&sslContextCache()->mutex);
+    return sslContextCache()->hits;
+}
+
+quint64 SslUnsafeContext::cacheMisses()
+{
+    QMutexLocker locker(&sslContextCache()->mutex);
+    return sslContextCache()->misses;
+}
+
 #if OPENSSL_VERSION_NUMBER >= 0x1000100fL && !defined(OPENSSL_NO_NEXTPROTONEG)
 
 static int next_proto_cb(SSL *, unsigned char **out, unsigned char *outlen,
@@ -123,13 +260,57 @@ SslUnsafeContext::NPNContext SslUnsafeContext::npnContext() const
 }
 #endif // OPENSSL_VERSION_NUMBER >= 0x1000100fL ...
 
+#if OPENSSL_VERSION_NUMBER >= 0x10001000L
+extern "C" {
+
+// alerts and handshake state changes, recorded by the socket set as extra data of the SSL structure
+static void q_ssl_info_callback(const SSL *ssl, int where, int ret)
+{
+    SslUnsafeSocketBackendPrivate *d = reinterpret_cast<SslUnsafeSocketBackendPrivate *>(q_SSL_get_ex_data(ssl, SslUnsafeSocketBackendPrivate::s_indexForSSLExtraData));
+    if (!d)
+        return;
+
+    if (where & SSL_CB_ALERT) {
+        d->addHandshakeEvent((where & SSL_CB_READ) ? SslUnsafeHandshakeEvent::AlertReceived : SslUnsafeHandshakeEvent::AlertSent,
+                             quint8(ret >> 8), quint16(ret & 0xff));
+    } else if (where & SSL_CB_HANDSHAKE_START) {
+        d->addHandshakeEvent(SslUnsafeHandshakeEvent::HandshakeStarted, 0, 0);
+    } else if (where & SSL_CB_HANDSHAKE_DONE) {
+        d->addHandshakeEvent(SslUnsafeHandshakeEvent::HandshakeDone, 0, 0);
+    }
+}
+
+// handshake messages and other protocol records, see recordHandshakeMessage()
+static void q_ssl_msg_callback(int write_p, int version, int content_type, const void *buf, size_t len, SSL *ssl, void *arg)
+{
+    Q_UNUSED(arg);
+
+    SslUnsafeSocketBackendPrivate *d = reinterpret_cast<SslUnsafeSocketBackendPrivate *>(q_SSL_get_ex_data(ssl, SslUnsafeSocketBackendPrivate::s_indexForSSLExtraData));
+    if (!d)
+        return;
+
+    d->recordHandshakeMessage(write_p, content_type, version, buf, len);
+}
+
+} // extern "C"
+#endif // OPENSSL_VERSION_NUMBER >= 0x10001000L
+
 // Needs to be deleted by caller
 SSL* SslUnsafeContext::createSsl()
 {
     SSL* ssl = q_SSL_new(ctx);
     q_SSL_clear(ssl);
 
-    if (!session && !sessionASN1().isEmpty()
+#if OPENSSL_VERSION_NUMBER >= 0x10001000L
+    // the socket finds its handshake events through the extra data, see initSslContext()
+    if (SslUnsafeSocket::sslLibraryVersionNumber() >= 0x10001000L) {
+        q_SSL_set_info_callback(ssl, q_ssl_info_callback);
+        q_SSL_set_msg_callback(ssl, q_ssl_msg_callback);
+    }
+#endif
+
+    // server contexts can be shared (see cachedFromConfiguration()), sessions are client-only
+    if (sslMode != SslUnsafeSocket::SslServerMode && !session && !sessionASN1().isEmpty()
             && !sslConfiguration.testSslOption(SslUnsafe::SslOptionDisableSessionPersistence)) {
         const unsigned char *data = reinterpret_cast<const unsigned char *>(m_sessionASN1.constData());
         session = q_d2i_SSL_SESSION(0, &data, m_sessionASN1.size()); // refcount is 1 already, set by function above
@@ -186,6 +367,10 @@ SSL* SslUnsafeContext::createSsl()
 // We cache exactly one session here
 bool SslUnsafeContext::cacheSession(SSL* ssl)
 {
+    // server contexts can be shared between sockets and never resume sessions
+    if (sslMode == SslUnsafeSocket::SslServerMode)
+        return true;
+
     // don't cache the same session again
     if (session && session == q_SSL_get_session(ssl))
         return true;
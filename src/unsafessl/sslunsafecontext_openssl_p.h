@@ -79,6 +79,11 @@ public:
                                           bool allowRootCertOnDemandLoading);
     static QSharedPointer<SslUnsafeContext> sharedFromConfiguration(SslUnsafeSocket::SslMode mode, const SslUnsafeConfiguration &configuration,
                                                                bool allowRootCertOnDemandLoading);
+    // returns a context shared between all sockets with the same configuration
+    static QSharedPointer<SslUnsafeContext> cachedFromConfiguration(SslUnsafeSocket::SslMode mode, const SslUnsafeConfiguration &configuration,
+                                                                    bool allowRootCertOnDemandLoading);
+    static quint64 cacheHits();
+    static quint64 cacheMisses();
 
     SslUnsafeError::SslError error() const;
     QString errorString() const;
@@ -111,8 +116,11 @@ protected:
 private:
     static void initSslContext(SslUnsafeContext* sslContext, SslUnsafeSocket::SslMode mode, const SslUnsafeConfiguration &configuration,
                                bool allowRootCertOnDemandLoading);
+    static QByteArray cacheKey(SslUnsafeSocket::SslMode mode, const SslUnsafeConfiguration &configuration,
+                               bool allowRootCertOnDemandLoading);
 
 private:
+    SslUnsafeSocket::SslMode sslMode;
     SSL_CTX* ctx;
     EVP_PKEY *pkey;
     SSL_SESSION *session;
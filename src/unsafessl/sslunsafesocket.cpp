@@ -1733,6 +1733,32 @@ QList<SslUnsafeError> SslUnsafeSocket::sslErrors() const
     return d->sslErrors;
 }
 
+/*!
+    Returns the alerts, handshake messages and state changes the SSL library
+    reported during the last handshake, in the order they happened. Unlike
+    errorString(), the codes do not depend on the library version.
+
+    The list is reset when a new handshake is started.
+*/
+QVector<SslUnsafeHandshakeEvent> SslUnsafeSocket::handshakeEvents() const
+{
+    Q_D(const SslUnsafeSocket);
+    return d->handshakeEvents;
+}
+
+/*!
+    Returns the records of the last handshake kept by the transcript,
+    oldest first. The list is empty unless recording was enabled with
+    setHandshakeTranscriptSize() before the handshake was started.
+
+    \sa setHandshakeTranscriptSize()
+*/
+QVector<SslUnsafeHandshakeRecord> SslUnsafeSocket::handshakeTranscript() const
+{
+    Q_D(const SslUnsafeSocket);
+    return d->transcript.records();
+}
+
 /*!
     Returns \c true if this platform supports SSL; otherwise, returns
     false. If the platform doesn't support SSL, the socket will fail
@@ -1792,6 +1818,60 @@ QString SslUnsafeSocket::sslLibraryBuildVersionString()
     return SslUnsafeSocketPrivate::sslLibraryBuildVersionString();
 }
 
+/*!
+    Returns how many server sockets reused an already initialized SSL
+    context built for the same configuration.
+
+    \sa sslContextCacheMisses()
+*/
+quint64 SslUnsafeSocket::sslContextCacheHits()
+{
+    return SslUnsafeContext::cacheHits();
+}
+
+/*!
+    Returns how many SSL contexts had to be initialized for server sockets
+    because no context for the same configuration was cached.
+
+    \sa sslContextCacheHits()
+*/
+quint64 SslUnsafeSocket::sslContextCacheMisses()
+{
+    return SslUnsafeContext::cacheMisses();
+}
+
+/*!
+    If \a enable is true, the system CA certificates are not looked for when
+    the SSL library is initialized. This saves startup time and memory of
+    applications which only accept connections without verifying peers.
+
+    The certificates are loaded the first time they are needed: by a client
+    socket, by a server socket verifying its peers, or by a call to
+    defaultCaCertificates() and addDefaultCaCertificates().
+    SslUnsafeConfiguration::defaultConfiguration() does not contain them
+    until then.
+
+    This function has to be called before the library is initialized.
+*/
+void SslUnsafeSocket::setServerOnlyInitialization(bool enable)
+{
+    SslUnsafeSocketPrivate::s_serverOnlyInitialization = enable;
+}
+
+/*!
+    Makes every socket starting a handshake afterwards record the handshake,
+    alert and ChangeCipherSpec records it exchanges into a ring buffer of
+    \a size bytes. The buffer is allocated once per socket, when the oldest
+    records do not fit anymore they are dropped. A \a size of 0 (the
+    default) disables recording.
+
+    \sa handshakeTranscript()
+*/
+void SslUnsafeSocket::setHandshakeTranscriptSize(int size)
+{
+    SslUnsafeSocketPrivate::s_handshakeTranscriptSize.store(qMax(size, 0));
+}
+
 /*!
     Starts a delayed SSL handshake for a client connection. This
     function can be called when the socket is in the \l ConnectedState
@@ -2133,6 +2213,18 @@ void SslUnsafeSocketPrivate::setDefaultSupportedCiphers(const QList<SslUnsafeCip
     globalData()->supportedCiphers = ciphers;
 }
 
+/*!
+    \internal
+*/
+void SslUnsafeSocketPrivate::setDefaultCipherLists(const QList<SslUnsafeCipher> &supportedCiphers,
+                                                   const QList<SslUnsafeCipher> &defaultCiphers)
+{
+    QMutexLocker locker(&globalData()->mutex);
+    globalData()->config.detach();
+    globalData()->supportedCiphers = supportedCiphers;
+    globalData()->config->ciphers = defaultCiphers;
+}
+
 /*!
     \internal
 */
@@ -2158,7 +2250,7 @@ void SslUnsafeSocketPrivate::setDefaultSupportedEllipticCurves(const QVector<Ssl
 */
 QList<SslUnsafeCertificate> SslUnsafeSocketPrivate::defaultCaCertificates()
 {
-    SslUnsafeSocketPrivate::ensureInitialized();
+    SslUnsafeSocketPrivate::ensureSystemCaCertificatesLoaded();
     QMutexLocker locker(&globalData()->mutex);
     return globalData()->config->caCertificates;
 }
@@ -2175,6 +2267,7 @@ void SslUnsafeSocketPrivate::setDefaultCaCertificates(const QList<SslUnsafeCerti
     // when the certificates are set explicitly, we do not want to
     // load the system certificates on demand
     s_loadRootCertsOnDemand = false;
+    s_loadedSystemCaCertificates.storeRelease(Initialized);
 }
 
 /*!
@@ -2183,7 +2276,7 @@ void SslUnsafeSocketPrivate::setDefaultCaCertificates(const QList<SslUnsafeCerti
 bool SslUnsafeSocketPrivate::addDefaultCaCertificates(const QString &path, SslUnsafe::EncodingFormat format,
                                                  QRegExp::PatternSyntax syntax)
 {
-    SslUnsafeSocketPrivate::ensureInitialized();
+    SslUnsafeSocketPrivate::ensureSystemCaCertificatesLoaded();
     QList<SslUnsafeCertificate> certs = SslUnsafeCertificate::fromPath(path, format, syntax);
     if (certs.isEmpty())
         return false;
@@ -2199,7 +2292,7 @@ bool SslUnsafeSocketPrivate::addDefaultCaCertificates(const QString &path, SslUn
 */
 void SslUnsafeSocketPrivate::addDefaultCaCertificate(const SslUnsafeCertificate &cert)
 {
-    SslUnsafeSocketPrivate::ensureInitialized();
+    SslUnsafeSocketPrivate::ensureSystemCaCertificatesLoaded();
     QMutexLocker locker(&globalData()->mutex);
     globalData()->config.detach();
     globalData()->config->caCertificates += cert;
@@ -2210,7 +2303,7 @@ void SslUnsafeSocketPrivate::addDefaultCaCertificate(const SslUnsafeCertificate
 */
 void SslUnsafeSocketPrivate::addDefaultCaCertificates(const QList<SslUnsafeCertificate> &certs)
 {
-    SslUnsafeSocketPrivate::ensureInitialized();
+    SslUnsafeSocketPrivate::ensureSystemCaCertificatesLoaded();
     QMutexLocker locker(&globalData()->mutex);
     globalData()->config.detach();
     globalData()->config->caCertificates += certs;
@@ -42,8 +42,10 @@
 #define SSLUNSAFESOCKET_H
 
 #include "sslunsafenetworkglobal.h"
+#include <QtCore/qbytearray.h>
 #include <QtCore/qlist.h>
 #include <QtCore/qregexp.h>
+#include <QtCore/qvector.h>
 #ifndef QT_NO_SSL
 #   include <QtNetwork/qtcpsocket.h>
 #   include "sslunsafeerror.h"
@@ -63,6 +65,37 @@ class SslUnsafePreSharedKeyAuthenticator;
 
 class SslUnsafeSocketPrivate;
 class SslUnsafeSocketBackendPrivate;
+
+// One step of a handshake, as reported by the SSL library while it runs.
+struct SslUnsafeHandshakeEvent
+{
+    enum Type : quint8 {
+        HandshakeStarted,
+        HandshakeDone,
+        HandshakeFailed,    // code is the library reason (ERR_GET_REASON) of the failure
+        MessageSent,        // code is the handshake message type
+        MessageReceived,
+        AlertSent,          // level and code are the alert level and description
+        AlertReceived
+    };
+
+    Type type;
+    quint8 level;
+    quint16 code;
+};
+Q_DECLARE_TYPEINFO(SslUnsafeHandshakeEvent, Q_PRIMITIVE_TYPE);
+
+// A handshake, alert or ChangeCipherSpec record as passed to or from the SSL library.
+struct SslUnsafeHandshakeRecord
+{
+    qint64 timestamp;   // nanoseconds since the handshake was started, monotonic
+    bool sent;
+    quint8 contentType;
+    quint16 version;
+    int size;           // data keeps only the beginning of records larger than the transcript
+    QByteArray data;
+};
+
 class Q_NETWORK_EXPORT SslUnsafeSocket : public QTcpSocket
 {
     Q_OBJECT
@@ -187,6 +220,8 @@ public:
     bool waitForDisconnected(int msecs = 30000) Q_DECL_OVERRIDE;
 
     QList<SslUnsafeError> sslErrors() const;
+    QVector<SslUnsafeHandshakeEvent> handshakeEvents() const;
+    QVector<SslUnsafeHandshakeRecord> handshakeTranscript() const;
 
     static bool supportsSsl();
     static long sslLibraryVersionNumber();
@@ -194,6 +229,12 @@ public:
     static long sslLibraryBuildVersionNumber();
     static QString sslLibraryBuildVersionString();
 
+    static quint64 sslContextCacheHits();
+    static quint64 sslContextCacheMisses();
+
+    static void setServerOnlyInitialization(bool enable);
+    static void setHandshakeTranscriptSize(int size);
+
     void ignoreSslErrors(const QList<SslUnsafeError> &errors);
 
 public Q_SLOTS:
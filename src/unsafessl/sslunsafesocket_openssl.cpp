@@ -73,6 +73,7 @@
 #include <QtCore/qelapsedtimer.h>
 #include <QtCore/qfile.h>
 #include <QtCore/qfileinfo.h>
+#include <QtCore/qhash.h>
 #include <QtCore/qmutex.h>
 #include <QtCore/qthread.h>
 #include <QtCore/qurl.h>
@@ -89,9 +90,14 @@ QT_BEGIN_NAMESPACE
     PtrCertCloseStore SslUnsafeSocketPrivate::ptrCertCloseStore = 0;
 #endif
 
-bool SslUnsafeSocketPrivate::s_libraryLoaded = false;
-bool SslUnsafeSocketPrivate::s_loadedCiphersAndCerts = false;
+QBasicAtomicInt SslUnsafeSocketPrivate::s_libraryLoaded = Q_BASIC_ATOMIC_INITIALIZER(SslUnsafeSocketPrivate::NotInitialized);
+QBasicAtomicInt SslUnsafeSocketPrivate::s_loadedCiphersAndCerts = Q_BASIC_ATOMIC_INITIALIZER(SslUnsafeSocketPrivate::NotInitialized);
+QBasicAtomicInt SslUnsafeSocketPrivate::s_loadedSystemCaCertificates = Q_BASIC_ATOMIC_INITIALIZER(SslUnsafeSocketPrivate::NotInitialized);
 bool SslUnsafeSocketPrivate::s_loadRootCertsOnDemand = false;
+bool SslUnsafeSocketPrivate::s_serverOnlyInitialization = false;
+QBasicAtomicInt SslUnsafeSocketPrivate::s_handshakeTranscriptSize = Q_BASIC_ATOMIC_INITIALIZER(0);
+
+Q_GLOBAL_STATIC(QMutex, systemCaCertificatesMutex)
 
 #if OPENSSL_VERSION_NUMBER >= 0x10001000L
 int SslUnsafeSocketBackendPrivate::s_indexForSSLExtraData = -1;
@@ -149,7 +155,23 @@ SslUnsafeSocketBackendPrivate::~SslUnsafeSocketBackendPrivate()
     destroySslContext();
 }
 
+// Every cipher of the loaded library, by its numeric id. Filled once by resetDefaultCiphers()
+// while the library is being initialized and only read afterwards, so a negotiated cipher
+// is found without parsing its description again.
+typedef QHash<unsigned long, SslUnsafeCipher> SslUnsafeCipherTable;
+Q_GLOBAL_STATIC(SslUnsafeCipherTable, libraryCiphers)
+
 SslUnsafeCipher SslUnsafeSocketBackendPrivate::SslUnsafeCipher_from_SSL_CIPHER(const SSL_CIPHER *cipher)
+{
+    const SslUnsafeCipherTable *table = libraryCiphers();
+    SslUnsafeCipherTable::const_iterator it = table->constFind(q_SSL_CIPHER_get_id(cipher));
+    if (it != table->constEnd())
+        return it.value();
+
+    return SslUnsafeCipher_describe(cipher);
+}
+
+SslUnsafeCipher SslUnsafeSocketBackendPrivate::SslUnsafeCipher_describe(const SSL_CIPHER *cipher)
 {
     SslUnsafeCipher ciph;
 
@@ -299,10 +321,20 @@ bool SslUnsafeSocketBackendPrivate::initSslContext()
 
     // If no external context was set (e.g. bei QHttpNetworkConnection) we will create a default context
     if (!sslContextPointer) {
+        // the configuration was copied before the system certificates were looked for
+        if (s_serverOnlyInitialization
+                && ((mode == SslUnsafeSocket::SslClientMode)
+                    || (configuration.peerVerifyMode == SslUnsafeSocket::VerifyPeer))) {
+            ensureSystemCaCertificatesLoaded();
+            if (allowRootCertOnDemandLoading && configuration.caCertificates.isEmpty())
+                configuration.caCertificates = defaultCaCertificates();
+        }
+
         // create a deep copy of our configuration
         SslUnsafeConfigurationPrivate *configurationCopy = new SslUnsafeConfigurationPrivate(configuration);
         configurationCopy->ref.store(0);              // the SslUnsafeConfiguration constructor refs up
-        sslContextPointer = SslUnsafeContext::sharedFromConfiguration(mode, configurationCopy, allowRootCertOnDemandLoading);
+        // identical server configurations reuse the same SSL_CTX
+        sslContextPointer = SslUnsafeContext::cachedFromConfiguration(mode, configurationCopy, allowRootCertOnDemandLoading);
     }
 
     if (sslContextPointer->error() != SslUnsafeError::NoError) {
@@ -343,6 +375,13 @@ bool SslUnsafeSocketBackendPrivate::initSslContext()
 
     // Clear the session.
     errorList.clear();
+    handshakeEvents.clear();
+    handshakeEvents.reserve(16);
+
+    // the buffer is only reallocated if its size was changed
+    transcript.setCapacity(s_handshakeTranscriptSize.load());
+    if (transcript.isEnabled())
+        transcriptTimer.start();
 
     // Initialize memory BIOs for encryption and decryption.
     readBio = q_BIO_new(q_BIO_s_mem());
@@ -398,7 +437,15 @@ void SslUnsafeSocketBackendPrivate::destroySslContext()
 
 bool SslUnsafeSocketPrivate::supportsSsl()
 {
-    return ensureLibraryLoaded();
+    // the outcome is final, no need to lock
+    switch (s_libraryLoaded.loadAcquire()) {
+    case Initialized:
+        return true;
+    case InitFailed:
+        return false;
+    default:
+        return ensureLibraryLoaded();
+    }
 }
 
 
@@ -414,6 +461,9 @@ void SslUnsafeSocketPrivate::ensureInitialized()
     if (!supportsSsl())
         return;
 
+    if (s_loadedCiphersAndCerts.loadAcquire() == Initialized)
+        return;
+
     ensureCiphersAndCertsLoaded();
 }
 
@@ -454,12 +504,15 @@ void SslUnsafeSocketPrivate::resetDefaultCiphers()
 
     QList<SslUnsafeCipher> ciphers;
     QList<SslUnsafeCipher> defaultCiphers;
+    SslUnsafeCipherTable *table = libraryCiphers();
+    table->clear();
 
     STACK_OF(SSL_CIPHER) *supportedCiphers = q_SSL_get_ciphers(mySsl);
     for (int i = 0; i < q_sk_SSL_CIPHER_num(supportedCiphers); ++i) {
         if (SSL_CIPHER *cipher = q_sk_SSL_CIPHER_value(supportedCiphers, i)) {
-            SslUnsafeCipher ciph = SslUnsafeSocketBackendPrivate::SslUnsafeCipher_from_SSL_CIPHER(cipher);
+            SslUnsafeCipher ciph = SslUnsafeSocketBackendPrivate::SslUnsafeCipher_describe(cipher);
             if (!ciph.isNull()) {
+                table->insert(q_SSL_CIPHER_get_id(cipher), ciph);
 #if 0
                 // Unconditionally exclude ADH and AECDH ciphers since they offer no MITM protection
                 if (!ciph.name().toLower().startsWith(QLatin1String("adh")) &&
@@ -477,11 +530,10 @@ void SslUnsafeSocketPrivate::resetDefaultCiphers()
         }
     }
 
-    q_SSL_CTX_free(myCtx);
     q_SSL_free(mySsl);
+    q_SSL_CTX_free(myCtx);
 
-    setDefaultSupportedCiphers(ciphers);
-    setDefaultCiphers(defaultCiphers);
+    setDefaultCipherLists(ciphers, defaultCiphers);
 }
 
 void SslUnsafeSocketPrivate::resetDefaultEllipticCurves()
@@ -588,6 +640,75 @@ QList<SslUnsafeCertificate> SslUnsafeSocketPrivate::systemCaCertificates()
 }
 #endif // Q_OS_DARWIN
 
+void SslUnsafeSocketPrivate::initSystemCaCertificates()
+{
+#if 1 // QT_CONFIG(library)
+    //load symbols needed to receive certificates from system store
+#if defined(Q_OS_WIN)
+    HINSTANCE hLib = LoadLibraryW(L"Crypt32");
+    if (hLib) {
+        ptrCertOpenSystemStoreW = (PtrCertOpenSystemStoreW)GetProcAddress(hLib, "CertOpenSystemStoreW");
+        ptrCertFindCertificateInStore = (PtrCertFindCertificateInStore)GetProcAddress(hLib, "CertFindCertificateInStore");
+        ptrCertCloseStore = (PtrCertCloseStore)GetProcAddress(hLib, "CertCloseStore");
+        if (!ptrCertOpenSystemStoreW || !ptrCertFindCertificateInStore || !ptrCertCloseStore)
+            qCWarning(lcSsl, "could not resolve symbols in crypt32 library"); // should never happen
+    } else {
+        qCWarning(lcSsl, "could not load crypt32 library"); // should never happen
+    }
+#elif defined(Q_OS_QNX)
+    s_loadRootCertsOnDemand = true;
+#elif defined(Q_OS_UNIX) && !defined(Q_OS_DARWIN)
+    // check whether we can enable on-demand root-cert loading (i.e. check whether the sym links are there)
+    QList<QByteArray> dirs = unixRootCertDirectories();
+    QStringList symLinkFilter;
+    symLinkFilter << QLatin1String("[0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f].[0-9]");
+    for (int a = 0; a < dirs.count(); ++a) {
+        QDirIterator iterator(QLatin1String(dirs.at(a)), symLinkFilter, QDir::Files);
+        if (iterator.hasNext()) {
+            s_loadRootCertsOnDemand = true;
+            break;
+        }
+    }
+#endif
+#endif // QT_CONFIG(library)
+    // if on-demand loading was not enabled, load the certs now
+    if (!s_loadRootCertsOnDemand)
+        setDefaultCaCertificates(systemCaCertificates());
+#ifdef Q_OS_WIN
+    //Enabled for fetching additional root certs from windows update on windows 6+
+    //This flag is set false by setDefaultCaCertificates() indicating the app uses
+    //its own cert bundle rather than the system one.
+    //Same logic that disables the unix on demand cert loading.
+    //Unlike unix, we do preload the certificates from the cert store.
+    if ((QSysInfo::windowsVersion() & QSysInfo::WV_NT_based) >= QSysInfo::WV_6_0)
+        s_loadRootCertsOnDemand = true;
+#endif
+}
+
+/*!
+    \internal
+
+    Looks for the system CA certificates if the library was initialized in
+    server-only mode. Does nothing if they are already known or if the default
+    CA certificates were replaced by the application.
+*/
+void SslUnsafeSocketPrivate::ensureSystemCaCertificatesLoaded()
+{
+    ensureInitialized();
+
+    if (s_loadedSystemCaCertificates.loadAcquire() == Initialized)
+        return;
+
+    const QMutexLocker locker(systemCaCertificatesMutex());
+    if (s_loadedSystemCaCertificates.load() != NotInitialized)
+        return;
+    s_loadedSystemCaCertificates.store(Initializing);
+
+    initSystemCaCertificates();
+
+    s_loadedSystemCaCertificates.storeRelease(Initialized);
+}
+
 void SslUnsafeSocketBackendPrivate::startClientEncryption()
 {
     if (!initSslContext()) {
@@ -908,6 +1029,10 @@ bool SslUnsafeSocketBackendPrivate::startHandshake()
             // The handshake is not yet complete.
             break;
         default:
+            // the earliest error is the cause, the others are reported by the functions it went through
+            if (unsigned long err = q_ERR_peek_error())
+                addHandshakeEvent(SslUnsafeHandshakeEvent::HandshakeFailed, 0, quint16(ERR_GET_REASON(err)));
+
             QString errorString
                     = SslUnsafeSocket::tr("Error during SSL handshake: %1").arg(getErrorsFromOpenSsl());
 #ifdef SSLUNSAFESOCKET_DEBUG
@@ -1074,6 +1199,34 @@ bool SslUnsafeSocketBackendPrivate::checkSslErrors()
     return true;
 }
 
+// a peer repeating warning alerts must not grow the log without bounds
+static const int maxHandshakeEvents = 64;
+
+void SslUnsafeSocketBackendPrivate::addHandshakeEvent(SslUnsafeHandshakeEvent::Type type, quint8 level, quint16 code)
+{
+    if (handshakeEvents.size() >= maxHandshakeEvents)
+        return;
+
+    SslUnsafeHandshakeEvent event = {type, level, code};
+    handshakeEvents.append(event);
+}
+
+void SslUnsafeSocketBackendPrivate::recordHandshakeMessage(bool sent, int contentType, int version, const void *buf, size_t len)
+{
+    // record headers and application data are not part of the transcript
+    if ((contentType != SSL3_RT_CHANGE_CIPHER_SPEC) && (contentType != SSL3_RT_ALERT)
+            && (contentType != SSL3_RT_HANDSHAKE))
+        return;
+
+    if (transcript.isEnabled())
+        transcript.append(transcriptTimer.nsecsElapsed(), sent, contentType, version, buf, len);
+
+    if ((contentType == SSL3_RT_HANDSHAKE) && (len > 0)) {
+        addHandshakeEvent(sent ? SslUnsafeHandshakeEvent::MessageSent : SslUnsafeHandshakeEvent::MessageReceived,
+                          0, *static_cast<const unsigned char *>(buf));
+    }
+}
+
 unsigned int SslUnsafeSocketBackendPrivate::tlsPskClientCallback(const char *hint,
                                                             char *identity, unsigned int max_identity_len,
                                                             unsigned char *psk, unsigned int max_psk_len)
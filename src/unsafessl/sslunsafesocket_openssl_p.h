@@ -170,6 +170,8 @@ public:
     void storePeerCertificates();
     unsigned int tlsPskClientCallback(const char *hint, char *identity, unsigned int max_identity_len, unsigned char *psk, unsigned int max_psk_len);
     unsigned int tlsPskServerCallback(const char *identity, unsigned char *psk, unsigned int max_psk_len);
+    void addHandshakeEvent(SslUnsafeHandshakeEvent::Type type, quint8 level, quint16 code);
+    void recordHandshakeMessage(bool sent, int contentType, int version, const void *buf, size_t len);
 #ifdef Q_OS_WIN
     void fetchCaRootForCert(const SslUnsafeCertificate &cert);
     void _q_caRootLoaded(SslUnsafeCertificate,SslUnsafeCertificate) Q_DECL_OVERRIDE;
@@ -177,6 +179,7 @@ public:
 
     Q_AUTOTEST_EXPORT static long setupOpenSslOptions(SslUnsafe::SslProtocol protocol, SslUnsafe::SslOptions sslOptions);
     static SslUnsafeCipher SslUnsafeCipher_from_SSL_CIPHER(const SSL_CIPHER *cipher);
+    static SslUnsafeCipher SslUnsafeCipher_describe(const SSL_CIPHER *cipher);
     static QList<SslUnsafeCertificate> STACKOFX509_to_SslUnsafeCertificates(STACK_OF(X509) *x509);
     static QList<SslUnsafeError> verify(const QList<SslUnsafeCertificate> &certificateChain, const QString &hostName);
     static QString getErrorsFromOpenSsl();
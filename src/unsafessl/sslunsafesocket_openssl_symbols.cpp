@@ -67,6 +67,9 @@
 #include <QtCore/qdatetime.h>
 #if defined(Q_OS_UNIX)
 #include <QtCore/qdir.h>
+#include <QtCore/qfile.h>
+#include <QtCore/qsavefile.h>
+#include <QtCore/qstandardpaths.h>
 #endif
 #if defined(Q_OS_LINUX) && !defined(Q_OS_ANDROID)
 #include <link.h>
@@ -317,6 +320,7 @@ DEFINEFUNC(void, DSA_free, DSA *a, a, return, DUMMYARG)
 DEFINEFUNC3(X509 *, d2i_X509, X509 **a, a, const unsigned char **b, b, long c, c, return 0, return)
 DEFINEFUNC2(char *, ERR_error_string, unsigned long a, a, char *b, b, return 0, return)
 DEFINEFUNC(unsigned long, ERR_get_error, DUMMYARG, DUMMYARG, return 0, return)
+DEFINEFUNC(unsigned long, ERR_peek_error, DUMMYARG, DUMMYARG, return 0, return)
 DEFINEFUNC(EVP_CIPHER_CTX *, EVP_CIPHER_CTX_new, void, DUMMYARG, return 0, return)
 DEFINEFUNC(void, EVP_CIPHER_CTX_free, EVP_CIPHER_CTX *a, a, return, DUMMYARG)
 DEFINEFUNC4(int, EVP_CIPHER_CTX_ctrl, EVP_CIPHER_CTX *ctx, ctx, int type, type, int arg, arg, void *ptr, ptr, return 0, return)
@@ -344,6 +348,7 @@ DEFINEFUNC(EC_KEY *, EVP_PKEY_get1_EC_KEY, EVP_PKEY *a, a, return 0, return)
 DEFINEFUNC(EVP_PKEY *, EVP_PKEY_new, DUMMYARG, DUMMYARG, return 0, return)
 DEFINEFUNC(int, EVP_PKEY_type, int a, a, return NID_undef, return)
 DEFINEFUNC2(int, i2d_X509, X509 *a, a, unsigned char **b, b, return -1, return)
+DEFINEFUNC2(int, i2d_PrivateKey, EVP_PKEY *a, a, unsigned char **b, b, return -1, return)
 DEFINEFUNC(const char *, OBJ_nid2sn, int a, a, return 0, return)
 DEFINEFUNC(const char *, OBJ_nid2ln, int a, a, return 0, return)
 DEFINEFUNC(int, OBJ_sn2nid, const char *s, s, return 0, return)
@@ -387,6 +392,11 @@ DEFINEFUNC(int, SSL_accept, SSL *a, a, return -1, return)
 DEFINEFUNC(int, SSL_clear, SSL *a, a, return -1, return)
 DEFINEFUNC3(char *, SSL_CIPHER_description, const SSL_CIPHER *a, a, char *b, b, int c, c, return 0, return)
 DEFINEFUNC2(int, SSL_CIPHER_get_bits, const SSL_CIPHER *a, a, int *b, b, return 0, return)
+#if QT_FEATURE_opensslv11 && OPENSSLV11 // QT_CONFIG(opensslv11)
+DEFINEFUNC(uint32_t, SSL_CIPHER_get_id, const SSL_CIPHER *a, a, return 0, return)
+#else
+DEFINEFUNC(unsigned long, SSL_CIPHER_get_id, const SSL_CIPHER *a, a, return 0, return)
+#endif
 DEFINEFUNC(int, SSL_connect, SSL *a, a, return -1, return)
 DEFINEFUNC(int, SSL_CTX_check_private_key, const SSL_CTX *a, a, return -1, return)
 DEFINEFUNC4(long, SSL_CTX_ctrl, SSL_CTX *a, a, int b, b, long c, c, void *d, d, return -1, return)
@@ -443,6 +453,8 @@ DEFINEFUNC2(void, SSL_set_psk_client_callback, SSL* ssl, ssl, q_psk_client_callb
 DEFINEFUNC2(void, SSL_set_psk_server_callback, SSL* ssl, ssl, q_psk_server_callback_t callback, callback, return, DUMMYARG)
 DEFINEFUNC2(int, SSL_CTX_use_psk_identity_hint, SSL_CTX* ctx, ctx, const char *hint, hint, return 0, return)
 #endif
+DEFINEFUNC2(void, SSL_set_info_callback, SSL *ssl, ssl, q_info_callback_t callback, callback, return, DUMMYARG)
+DEFINEFUNC2(void, SSL_set_msg_callback, SSL *ssl, ssl, q_msg_callback_t callback, callback, return, DUMMYARG)
 DEFINEFUNC3(int, SSL_write, SSL *a, a, const void *b, b, int c, c, return -1, return)
 DEFINEFUNC2(int, X509_cmp, X509 *a, a, X509 *b, b, return -1, return)
 DEFINEFUNC4(int, X509_digest, const X509 *x509, x509, const EVP_MD *type, type, unsigned char *md, md, unsigned int *len, len, return -1, return)
@@ -537,8 +549,7 @@ DEFINEFUNC2(PKCS12 *, d2i_PKCS12_bio, BIO *bio, bio, PKCS12 **pkcs12, pkcs12, re
 DEFINEFUNC(void, PKCS12_free, PKCS12 *pkcs12, pkcs12, return, DUMMYARG)
 
 #define RESOLVEFUNC(func) \
-    if (!(_q_##func = _q_PTR_##func(libs.first->resolve(#func)))     \
-        && !(_q_##func = _q_PTR_##func(libs.second->resolve(#func)))) \
+    if (!q_resolveOpenSslSymbol(#func, &_q_##func)) \
         qsslSocketCannotResolveSymbolWarning(#func);
 
 #if !defined QT_LINKED_OPENSSL
@@ -552,8 +563,41 @@ bool q_resolveOpenSslSymbols()
                      "of libraries.");
     return false;
 }
+
+void *q_resolveOpenSslSymbol(const char *, QBasicAtomicPointer<void> *)
+{
+    return nullptr;
+}
 #else
 
+#ifdef Q_OS_WIN
+typedef QSystemLibrary SslLibrary;
+#else
+typedef QLibrary SslLibrary;
+#endif
+
+// set once the libraries are loaded and kept until exit, symbols are resolved on demand
+static QBasicAtomicPointer<SslLibrary> sslLibrary = Q_BASIC_ATOMIC_INITIALIZER(nullptr);
+static QBasicAtomicPointer<SslLibrary> cryptoLibrary = Q_BASIC_ATOMIC_INITIALIZER(nullptr);
+
+void *q_resolveOpenSslSymbol(const char *name, QBasicAtomicPointer<void> *address)
+{
+    SslLibrary *libssl = sslLibrary.loadAcquire();
+    SslLibrary *libcrypto = cryptoLibrary.loadAcquire();
+
+    if (!libssl || !libcrypto)
+        return nullptr;
+
+    void *symbol = reinterpret_cast<void *>(libssl->resolve(name));
+    if (!symbol)
+        symbol = reinterpret_cast<void *>(libcrypto->resolve(name));
+
+    // concurrent callers store the same address, a missing symbol is not looked up again
+    address->storeRelease(symbol ? symbol : q_missingOpenSslSymbol());
+
+    return symbol;
+}
+
 # ifdef Q_OS_UNIX
 struct NumericallyLess
 {
@@ -744,9 +788,75 @@ static QPair<QSystemLibrary*, QSystemLibrary*> loadOpenSslWin32()
 }
 #else
 
-static QPair<QLibrary*, QLibrary*> loadOpenSsl()
+# if defined(Q_OS_UNIX)
+// Paths of the libraries which passed the version check are remembered between runs,
+// this avoids scanning library directories each time the tool is started.
+// The cache is bound to the OpenSSL version the code is built against.
+static QString libraryCachePath()
+{
+    QString dir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (dir.isEmpty())
+        return QString();
+    return dir + QLatin1String("/openssl-libraries");
+}
+
+static QByteArray libraryCacheHeader()
+{
+    return QByteArray::number(qulonglong(OPENSSL_VERSION_NUMBER), 16);
+}
+
+static bool loadCachedOpenSsl(QLibrary *libssl, QLibrary *libcrypto)
+{
+    QFile file(libraryCachePath());
+    if (file.fileName().isEmpty() || !file.open(QIODevice::ReadOnly))
+        return false;
+
+    const QList<QByteArray> lines = file.readAll().split('\n');
+    if ((lines.size() < 3) || (lines.at(0) != libraryCacheHeader()))
+        return false;
+
+    libssl->setFileNameAndVersion(QFile::decodeName(lines.at(1)), -1);
+    libcrypto->setFileNameAndVersion(QFile::decodeName(lines.at(2)), -1);
+    if (libcrypto->load() && libssl->load())
+        return true;
+
+    libssl->unload();
+    libcrypto->unload();
+    return false;
+}
+
+static void storeCachedOpenSsl(const QLibrary *libssl, const QLibrary *libcrypto)
+{
+    QString path = libraryCachePath();
+    if (path.isEmpty() || !QDir().mkpath(QFileInfo(path).absolutePath()))
+        return;
+
+    QByteArray data = libraryCacheHeader() + '\n'
+            + QFile::encodeName(libssl->fileName()) + '\n'
+            + QFile::encodeName(libcrypto->fileName()) + '\n';
+
+    QFile current(path);
+    if (current.open(QIODevice::ReadOnly) && (current.readAll() == data))
+        return;
+    current.close();
+
+    QSaveFile file(path);
+    if (file.open(QIODevice::WriteOnly) && (file.write(data) == data.size()))
+        file.commit();
+}
+
+static void removeCachedOpenSsl()
+{
+    QString path = libraryCachePath();
+    if (!path.isEmpty())
+        QFile::remove(path);
+}
+# endif
+
+static QPair<QLibrary*, QLibrary*> loadOpenSsl(bool useCache, bool *fromCache)
 {
     QPair<QLibrary*,QLibrary*> pair;
+    *fromCache = false;
 
 # if defined(Q_OS_UNIX)
     QLibrary *&libssl = pair.first;
@@ -754,6 +864,16 @@ static QPair<QLibrary*, QLibrary*> loadOpenSsl()
     libssl = new QLibrary;
     libcrypto = new QLibrary;
 
+#ifdef Q_OS_OPENBSD
+    libcrypto->setLoadHints(QLibrary::ExportExternalSymbolsHint);
+#endif
+
+    // zeroth attempt: the libraries found by a previous run
+    if (useCache && loadCachedOpenSsl(libssl, libcrypto)) {
+        *fromCache = true;
+        return pair;
+    }
+
     // Try to find the libssl library on the system.
     //
     // Up until Qt 4.3, this only searched for the "ssl" library at version -1, that
@@ -776,9 +896,6 @@ static QPair<QLibrary*, QLibrary*> loadOpenSsl()
     // DT_RPATH tags on our library header as well as other system-specific search
     // paths. See the man page for dlopen(3) on your system for more information.
 
-#ifdef Q_OS_OPENBSD
-    libcrypto->setLoadHints(QLibrary::ExportExternalSymbolsHint);
-#endif
 #if defined(SHLIB_VERSION_NUMBER) && !defined(Q_OS_QNX) // on QNX, the libs are always libssl.so and libcrypto.so
     // first attempt: the canonical name is libssl.so.<SHLIB_VERSION_NUMBER>
     libssl->setFileNameAndVersion(QLatin1String("ssl"), QLatin1String(SHLIB_VERSION_NUMBER));
@@ -866,381 +983,122 @@ static QPair<QLibrary*, QLibrary*> loadOpenSsl()
 }
 #endif
 
-bool q_resolveOpenSslSymbols()
+template <typename Library>
+static void unloadOpenSsl(const QPair<Library *, Library *> &libs)
 {
-    static bool symbolsResolved = false;
-    static bool triedToResolveSymbols = false;
-#ifndef QT_NO_THREAD
+    sslLibrary.storeRelease(nullptr);
+    cryptoLibrary.storeRelease(nullptr);
+    // the version check resolves these, the addresses (or missing marks) belong to the unloaded libraries
 #if QT_FEATURE_opensslv11 && OPENSSLV11 // QT_CONFIG(opensslv11)
-    QMutexLocker locker(SslUnsafeMutexPool::globalInstanceGet((void *)&q_OPENSSL_init_ssl));
+    _q_OPENSSL_init_ssl.storeRelease(nullptr);
+    _q_OPENSSL_init_crypto.storeRelease(nullptr);
+    _q_OpenSSL_version_num.storeRelease(nullptr);
+    _q_OpenSSL_version.storeRelease(nullptr);
 #else
-    QMutexLocker locker(SslUnsafeMutexPool::globalInstanceGet((void *)&q_SSL_library_init));
+    _q_SSL_library_init.storeRelease(nullptr);
+    _q_SSL_load_error_strings.storeRelease(nullptr);
+    _q_SSLeay.storeRelease(nullptr);
+    _q_SSLeay_version.storeRelease(nullptr);
 #endif
+    delete libs.first;
+    delete libs.second;
+#if !defined(Q_OS_WIN) && defined(Q_OS_UNIX)
+    // the cached libraries are not usable anymore, they are looked for again next time
+    removeCachedOpenSsl();
 #endif
-    if (symbolsResolved)
-        return true;
-    if (triedToResolveSymbols)
-        return false;
-    triedToResolveSymbols = true;
+}
 
-#ifdef Q_OS_WIN
-    QPair<QSystemLibrary *, QSystemLibrary *> libs = loadOpenSslWin32();
-#else
-    QPair<QLibrary *, QLibrary *> libs = loadOpenSsl();
-#endif
-    if (!libs.first || !libs.second)
-        // failed to load them
-        return false;
+// everything else is resolved on the first use, only the library version is checked here
+template <typename Library>
+static bool checkOpenSslVersion(const QPair<Library *, Library *> &libs)
+{
+    sslLibrary.storeRelease(libs.first);
+    cryptoLibrary.storeRelease(libs.second);
 
 #if QT_FEATURE_opensslv11 && OPENSSLV11 // QT_CONFIG(opensslv11)
 
     RESOLVEFUNC(OPENSSL_init_ssl)
     RESOLVEFUNC(OPENSSL_init_crypto)
-    RESOLVEFUNC(ASN1_STRING_get0_data)
-    RESOLVEFUNC(EVP_CIPHER_CTX_reset)
-    RESOLVEFUNC(EVP_PKEY_base_id)
-    RESOLVEFUNC(RSA_bits)
-    RESOLVEFUNC(OPENSSL_sk_new_null)
-    RESOLVEFUNC(OPENSSL_sk_push)
-    RESOLVEFUNC(OPENSSL_sk_free)
-    RESOLVEFUNC(OPENSSL_sk_num)
-    RESOLVEFUNC(OPENSSL_sk_pop_free)
-    RESOLVEFUNC(OPENSSL_sk_value)
-    RESOLVEFUNC(DH_get0_pqg)
-    RESOLVEFUNC(SSL_CTX_set_options)
-    RESOLVEFUNC(SSL_get_client_random)
-    RESOLVEFUNC(SSL_SESSION_get_master_key)
-    RESOLVEFUNC(SSL_session_reused)
-    RESOLVEFUNC(SSL_get_session)
-    RESOLVEFUNC(CRYPTO_get_ex_new_index)
-    RESOLVEFUNC(TLS_method)
-    RESOLVEFUNC(TLS_client_method)
-    RESOLVEFUNC(TLS_server_method)
-    RESOLVEFUNC(X509_STORE_CTX_get0_chain)
-    RESOLVEFUNC(X509_getm_notBefore)
-    RESOLVEFUNC(X509_getm_notAfter)
-    RESOLVEFUNC(X509_get_version)
-    RESOLVEFUNC(X509_get_pubkey)
-    RESOLVEFUNC(X509_STORE_set_verify_cb)
-    RESOLVEFUNC(CRYPTO_free)
     RESOLVEFUNC(OpenSSL_version_num)
     RESOLVEFUNC(OpenSSL_version)
-    if (!_q_OpenSSL_version) {
-        // Apparently, we were built with OpenSSL 1.1 enabled but are now using
-        // a wrong library.
-        delete libs.first;
-        delete libs.second;
-        qCWarning(lcSsl, "Incompatible version of OpenSSL");
+    // Apparently, we were built with OpenSSL 1.1 enabled but are now using
+    // a wrong library.
+    if (!_q_OpenSSL_version.load())
         return false;
-    }
-
-    RESOLVEFUNC(SSL_SESSION_get_ticket_lifetime_hint)
-    RESOLVEFUNC(DH_bits)
-    RESOLVEFUNC(DSA_bits)
 
 #else // !opensslv11
 
-    RESOLVEFUNC(ASN1_STRING_data)
-
-#ifdef SSLEAY_MACROS
-    RESOLVEFUNC(ASN1_dup)
-#endif // SSLEAY_MACROS
-    RESOLVEFUNC(BIO_new_file)
-    RESOLVEFUNC(ERR_clear_error)
-    RESOLVEFUNC(CRYPTO_free)
-    RESOLVEFUNC(CRYPTO_num_locks)
-    RESOLVEFUNC(CRYPTO_set_id_callback)
-    RESOLVEFUNC(CRYPTO_set_locking_callback)
-    RESOLVEFUNC(ERR_peek_last_error)
-    RESOLVEFUNC(ERR_free_strings)
-    RESOLVEFUNC(EVP_CIPHER_CTX_cleanup)
-    RESOLVEFUNC(EVP_CIPHER_CTX_init)
-
-#ifdef SSLEAY_MACROS // ### verify
-    RESOLVEFUNC(PEM_ASN1_read_bio)
-#endif // SSLEAY_MACROS
-
-    RESOLVEFUNC(sk_new_null)
-    RESOLVEFUNC(sk_push)
-    RESOLVEFUNC(sk_free)
-    RESOLVEFUNC(sk_num)
-    RESOLVEFUNC(sk_pop_free)
-    RESOLVEFUNC(sk_value)
     RESOLVEFUNC(SSL_library_init)
     RESOLVEFUNC(SSL_load_error_strings)
-#if OPENSSL_VERSION_NUMBER >= 0x10001000L
-    RESOLVEFUNC(SSL_get_ex_new_index)
-#endif
-#ifndef OPENSSL_NO_SSL2
-    RESOLVEFUNC(SSLv2_client_method)
-#endif
-#ifndef OPENSSL_NO_SSL3_METHOD
-    RESOLVEFUNC(SSLv3_client_method)
-#endif
-    RESOLVEFUNC(SSLv23_client_method)
-    RESOLVEFUNC(TLSv1_client_method)
-#if OPENSSL_VERSION_NUMBER >= 0x10001000L
-    RESOLVEFUNC(TLSv1_1_client_method)
-    RESOLVEFUNC(TLSv1_2_client_method)
-#endif
-#ifndef OPENSSL_NO_SSL2
-    RESOLVEFUNC(SSLv2_server_method)
-#endif
-#ifndef OPENSSL_NO_SSL3_METHOD
-    RESOLVEFUNC(SSLv3_server_method)
-#endif
-    RESOLVEFUNC(SSLv23_server_method)
-    RESOLVEFUNC(TLSv1_server_method)
-#if OPENSSL_VERSION_NUMBER >= 0x10001000L
-    RESOLVEFUNC(TLSv1_1_server_method)
-    RESOLVEFUNC(TLSv1_2_server_method)
-#endif
-    RESOLVEFUNC(X509_STORE_CTX_get_chain)
-#ifdef SSLEAY_MACROS
-    RESOLVEFUNC(i2d_DSAPrivateKey)
-    RESOLVEFUNC(i2d_RSAPrivateKey)
-    RESOLVEFUNC(d2i_DSAPrivateKey)
-    RESOLVEFUNC(d2i_RSAPrivateKey)
-#endif
-    RESOLVEFUNC(CONF_get1_default_config_file)
-    RESOLVEFUNC(OPENSSL_add_all_algorithms_noconf)
-    RESOLVEFUNC(OPENSSL_add_all_algorithms_conf)
     RESOLVEFUNC(SSLeay)
 
-    if (!_q_SSLeay || q_SSLeay() >= 0x10100000L) {
-        // OpenSSL 1.1 has deprecated and removed SSLeay. We consider a failure to
-        // resolve this symbol as a failure to resolve symbols.
-        // The right operand of '||' above is ... a bit of paranoia.
-        delete libs.first;
-        delete libs.second;
-        qCWarning(lcSsl, "Incompatible version of OpenSSL");
+    // OpenSSL 1.1 has deprecated and removed SSLeay. We consider a failure to
+    // resolve this symbol as a failure to resolve symbols.
+    // The right operand of '||' below is ... a bit of paranoia.
+    if (!_q_SSLeay.load() || q_SSLeay() >= 0x10100000L)
         return false;
-    }
-
 
     RESOLVEFUNC(SSLeay_version)
 
-#ifndef OPENSSL_NO_EC
-#if OPENSSL_VERSION_NUMBER >= 0x10002000L
-    if (q_SSLeay() >= 0x10002000L)
-        RESOLVEFUNC(EC_curve_nist2nid)
-#endif // OPENSSL_VERSION_NUMBER >= 0x10002000L
-#endif // OPENSSL_NO_EC
-
-
 #endif // !opensslv11
 
-    RESOLVEFUNC(ASN1_INTEGER_get)
-    RESOLVEFUNC(ASN1_STRING_length)
-    RESOLVEFUNC(ASN1_STRING_to_UTF8)
-    RESOLVEFUNC(BIO_ctrl)
-    RESOLVEFUNC(BIO_free)
-    RESOLVEFUNC(BIO_new)
-    RESOLVEFUNC(BIO_new_mem_buf)
-    RESOLVEFUNC(BIO_read)
-    RESOLVEFUNC(BIO_s_mem)
-    RESOLVEFUNC(BIO_write)
-#ifndef OPENSSL_NO_EC
-    RESOLVEFUNC(EC_KEY_get0_group)
-    RESOLVEFUNC(EC_GROUP_get_degree)
-#endif
-    RESOLVEFUNC(BN_new)
-    RESOLVEFUNC(BN_num_bits)
-#if OPENSSL_VERSION_NUMBER >= 0x10100000L
-    RESOLVEFUNC(BN_is_word)
-#endif
-    RESOLVEFUNC(BN_mod_word)
-    RESOLVEFUNC(BN_set_word)
-    RESOLVEFUNC(BN_free)
-    RESOLVEFUNC(DSA_new)
-    RESOLVEFUNC(DSA_free)
-    RESOLVEFUNC(ERR_error_string)
-    RESOLVEFUNC(ERR_get_error)
-    RESOLVEFUNC(EVP_CIPHER_CTX_new)
-    RESOLVEFUNC(EVP_CIPHER_CTX_free)
-    RESOLVEFUNC(EVP_CIPHER_CTX_ctrl)
-    RESOLVEFUNC(EVP_CIPHER_CTX_set_key_length)
-    RESOLVEFUNC(EVP_CipherInit)
-    RESOLVEFUNC(EVP_CipherInit_ex)
-    RESOLVEFUNC(EVP_CipherUpdate)
-    RESOLVEFUNC(EVP_CipherFinal)
-    RESOLVEFUNC(EVP_des_cbc)
-    RESOLVEFUNC(EVP_des_ede3_cbc)
-    RESOLVEFUNC(EVP_rc2_cbc)
-    RESOLVEFUNC(EVP_sha1)
-    RESOLVEFUNC(EVP_PKEY_assign)
-    RESOLVEFUNC(EVP_PKEY_set1_RSA)
-    RESOLVEFUNC(EVP_PKEY_set1_DSA)
-#ifndef OPENSSL_NO_EC
-    RESOLVEFUNC(EVP_PKEY_set1_EC_KEY)
-#endif
-    RESOLVEFUNC(EVP_PKEY_free)
-    RESOLVEFUNC(EVP_PKEY_get1_DSA)
-    RESOLVEFUNC(EVP_PKEY_get1_RSA)
-#ifndef OPENSSL_NO_EC
-    RESOLVEFUNC(EVP_PKEY_get1_EC_KEY)
-#endif
-    RESOLVEFUNC(EVP_PKEY_new)
-    RESOLVEFUNC(EVP_PKEY_type)
-    RESOLVEFUNC(OBJ_nid2sn)
-    RESOLVEFUNC(OBJ_nid2ln)
-    RESOLVEFUNC(OBJ_sn2nid)
-    RESOLVEFUNC(OBJ_ln2nid)
-    RESOLVEFUNC(i2t_ASN1_OBJECT)
-    RESOLVEFUNC(OBJ_obj2txt)
-    RESOLVEFUNC(OBJ_obj2nid)
+    return true;
+}
 
-#ifndef SSLEAY_MACROS
-    RESOLVEFUNC(PEM_read_bio_PrivateKey)
-    RESOLVEFUNC(PEM_read_bio_DSAPrivateKey)
-    RESOLVEFUNC(PEM_read_bio_RSAPrivateKey)
-#ifndef OPENSSL_NO_EC
-    RESOLVEFUNC(PEM_read_bio_ECPrivateKey)
+bool q_resolveOpenSslSymbols()
+{
+    static bool symbolsResolved = false;
+    static bool triedToResolveSymbols = false;
+#ifndef QT_NO_THREAD
+#if QT_FEATURE_opensslv11 && OPENSSLV11 // QT_CONFIG(opensslv11)
+    QMutexLocker locker(SslUnsafeMutexPool::globalInstanceGet((void *)&q_OPENSSL_init_ssl));
+#else
+    QMutexLocker locker(SslUnsafeMutexPool::globalInstanceGet((void *)&q_SSL_library_init));
 #endif
-    RESOLVEFUNC(PEM_read_bio_DHparams)
-    RESOLVEFUNC(PEM_write_bio_DSAPrivateKey)
-    RESOLVEFUNC(PEM_write_bio_RSAPrivateKey)
-#ifndef OPENSSL_NO_EC
-    RESOLVEFUNC(PEM_write_bio_ECPrivateKey)
 #endif
-#endif // !SSLEAY_MACROS
+    if (symbolsResolved)
+        return true;
+    if (triedToResolveSymbols)
+        return false;
+    triedToResolveSymbols = true;
 
-    RESOLVEFUNC(PEM_read_bio_PUBKEY)
-    RESOLVEFUNC(PEM_read_bio_DSA_PUBKEY)
-    RESOLVEFUNC(PEM_read_bio_RSA_PUBKEY)
-#ifndef OPENSSL_NO_EC
-    RESOLVEFUNC(PEM_read_bio_EC_PUBKEY)
-#endif
-    RESOLVEFUNC(PEM_write_bio_DSA_PUBKEY)
-    RESOLVEFUNC(PEM_write_bio_RSA_PUBKEY)
-#ifndef OPENSSL_NO_EC
-    RESOLVEFUNC(PEM_write_bio_EC_PUBKEY)
-#endif
-    RESOLVEFUNC(RAND_seed)
-    RESOLVEFUNC(RAND_status)
-    RESOLVEFUNC(RSA_new)
-    RESOLVEFUNC(RSA_free)
-    RESOLVEFUNC(RSA_generate_key_ex)
-    RESOLVEFUNC(SSL_CIPHER_description)
-    RESOLVEFUNC(SSL_CIPHER_get_bits)
-    RESOLVEFUNC(SSL_CTX_check_private_key)
-    RESOLVEFUNC(SSL_CTX_ctrl)
-    RESOLVEFUNC(SSL_CTX_free)
-    RESOLVEFUNC(SSL_CTX_new)
-    RESOLVEFUNC(SSL_CTX_set_cipher_list)
-    RESOLVEFUNC(SSL_CTX_set_default_verify_paths)
-    RESOLVEFUNC(SSL_CTX_set_verify)
-    RESOLVEFUNC(SSL_CTX_set_verify_depth)
-    RESOLVEFUNC(SSL_CTX_use_certificate)
-    RESOLVEFUNC(SSL_CTX_use_certificate_file)
-    RESOLVEFUNC(SSL_CTX_use_PrivateKey)
-    RESOLVEFUNC(SSL_CTX_use_RSAPrivateKey)
-    RESOLVEFUNC(SSL_CTX_use_PrivateKey_file)
-    RESOLVEFUNC(SSL_CTX_get_cert_store);
-    RESOLVEFUNC(SSL_accept)
-    RESOLVEFUNC(SSL_clear)
-    RESOLVEFUNC(SSL_connect)
-    RESOLVEFUNC(SSL_free)
-    RESOLVEFUNC(SSL_get_ciphers)
-    RESOLVEFUNC(SSL_get_current_cipher)
-    RESOLVEFUNC(SSL_version)
-    RESOLVEFUNC(SSL_get_error)
-    RESOLVEFUNC(SSL_get_peer_cert_chain)
-    RESOLVEFUNC(SSL_get_peer_certificate)
-    RESOLVEFUNC(SSL_get_verify_result)
-    RESOLVEFUNC(SSL_new)
-    RESOLVEFUNC(SSL_ctrl)
-    RESOLVEFUNC(SSL_read)
-    RESOLVEFUNC(SSL_set_accept_state)
-    RESOLVEFUNC(SSL_set_bio)
-    RESOLVEFUNC(SSL_set_connect_state)
-    RESOLVEFUNC(SSL_shutdown)
-    RESOLVEFUNC(SSL_set_session)
-    RESOLVEFUNC(SSL_SESSION_free)
-    RESOLVEFUNC(SSL_get1_session)
-    RESOLVEFUNC(SSL_get_session)
-#if OPENSSL_VERSION_NUMBER >= 0x10001000L
-    RESOLVEFUNC(SSL_set_ex_data)
-    RESOLVEFUNC(SSL_get_ex_data)
+#ifdef Q_OS_WIN
+    QPair<QSystemLibrary *, QSystemLibrary *> libs = loadOpenSslWin32();
+    bool fromCache = false;
+#else
+    bool fromCache;
+    QPair<QLibrary *, QLibrary *> libs = loadOpenSsl(true, &fromCache);
 #endif
-#if OPENSSL_VERSION_NUMBER >= 0x10001000L && !defined(OPENSSL_NO_PSK)
-    RESOLVEFUNC(SSL_set_psk_client_callback)
-    RESOLVEFUNC(SSL_set_psk_server_callback)
-    RESOLVEFUNC(SSL_CTX_use_psk_identity_hint)
+    if (!libs.first || !libs.second)
+        // failed to load them
+        return false;
+
+    if (!checkOpenSslVersion(libs)) {
+        unloadOpenSsl(libs);
+        if (!fromCache) {
+            qCWarning(lcSsl, "Incompatible version of OpenSSL");
+            return false;
+        }
+
+#ifndef Q_OS_WIN
+        // the cached libraries were replaced since the previous run, look for them again
+        libs = loadOpenSsl(false, &fromCache);
+        if (!libs.first || !libs.second)
+            return false;
+
+        if (!checkOpenSslVersion(libs)) {
+            unloadOpenSsl(libs);
+            qCWarning(lcSsl, "Incompatible version of OpenSSL");
+            return false;
+        }
 #endif
-    RESOLVEFUNC(SSL_write)
-    RESOLVEFUNC(X509_NAME_entry_count)
-    RESOLVEFUNC(X509_NAME_get_entry)
-    RESOLVEFUNC(X509_NAME_ENTRY_get_data)
-    RESOLVEFUNC(X509_NAME_ENTRY_get_object)
-    RESOLVEFUNC(X509_PUBKEY_get)
-    RESOLVEFUNC(X509_STORE_free)
-    RESOLVEFUNC(X509_STORE_new)
-    RESOLVEFUNC(X509_STORE_add_cert)
-    RESOLVEFUNC(X509_STORE_CTX_free)
-    RESOLVEFUNC(X509_STORE_CTX_init)
-    RESOLVEFUNC(X509_STORE_CTX_new)
-    RESOLVEFUNC(X509_STORE_CTX_set_purpose)
-    RESOLVEFUNC(X509_STORE_CTX_get_error)
-    RESOLVEFUNC(X509_STORE_CTX_get_error_depth)
-    RESOLVEFUNC(X509_STORE_CTX_get_current_cert)
-    RESOLVEFUNC(X509_cmp)
-#ifndef SSLEAY_MACROS
-    RESOLVEFUNC(X509_dup)
+    }
+
+#if !defined(Q_OS_WIN) && defined(Q_OS_UNIX)
+    storeCachedOpenSsl(libs.first, libs.second);
 #endif
-    RESOLVEFUNC(X509_print)
-    RESOLVEFUNC(X509_digest)
-    RESOLVEFUNC(X509_EXTENSION_get_object)
-    RESOLVEFUNC(X509_free)
-    RESOLVEFUNC(X509_get_ext)
-    RESOLVEFUNC(X509_get_ext_count)
-    RESOLVEFUNC(X509_get_ext_d2i)
-    RESOLVEFUNC(X509V3_EXT_get)
-    RESOLVEFUNC(X509V3_EXT_d2i)
-    RESOLVEFUNC(X509_EXTENSION_get_critical)
-    RESOLVEFUNC(X509_EXTENSION_get_data)
-    RESOLVEFUNC(BASIC_CONSTRAINTS_free)
-    RESOLVEFUNC(AUTHORITY_KEYID_free)
-    RESOLVEFUNC(ASN1_STRING_print)
-    RESOLVEFUNC(X509_check_issued)
-    RESOLVEFUNC(X509_get_issuer_name)
-    RESOLVEFUNC(X509_get_subject_name)
-    RESOLVEFUNC(X509_get_serialNumber)
-    RESOLVEFUNC(X509_verify_cert)
-    RESOLVEFUNC(d2i_X509)
-    RESOLVEFUNC(i2d_X509)
-    RESOLVEFUNC(SSL_CTX_load_verify_locations)
-    RESOLVEFUNC(i2d_SSL_SESSION)
-    RESOLVEFUNC(d2i_SSL_SESSION)
-#if OPENSSL_VERSION_NUMBER >= 0x1000100fL && !defined(OPENSSL_NO_NEXTPROTONEG)
-    RESOLVEFUNC(SSL_select_next_proto)
-    RESOLVEFUNC(SSL_CTX_set_next_proto_select_cb)
-    RESOLVEFUNC(SSL_get0_next_proto_negotiated)
-#endif // OPENSSL_VERSION_NUMBER >= 0x1000100fL ...
-#if OPENSSL_VERSION_NUMBER >= 0x10002000L
-    RESOLVEFUNC(SSL_set_alpn_protos)
-    RESOLVEFUNC(SSL_CTX_set_alpn_select_cb)
-    RESOLVEFUNC(SSL_get0_alpn_selected)
-#endif // OPENSSL_VERSION_NUMBER >= 0x10002000L ...
-    RESOLVEFUNC(DH_new)
-    RESOLVEFUNC(DH_free)
-    RESOLVEFUNC(d2i_DHparams)
-    RESOLVEFUNC(i2d_DHparams)
-    RESOLVEFUNC(DH_check)
-    RESOLVEFUNC(BN_bin2bn)
-#ifndef OPENSSL_NO_EC
-    RESOLVEFUNC(EC_KEY_dup)
-    RESOLVEFUNC(EC_KEY_new_by_curve_name)
-    RESOLVEFUNC(EC_KEY_free)
-    RESOLVEFUNC(EC_get_builtin_curves)
-#endif // OPENSSL_NO_EC
-    RESOLVEFUNC(PKCS12_parse)
-    RESOLVEFUNC(d2i_PKCS12_bio)
-    RESOLVEFUNC(PKCS12_free)
 
     symbolsResolved = true;
-    delete libs.first;
-    delete libs.second;
     return true;
 }
 #endif // QT_CONFIG(library)
@@ -71,6 +71,7 @@
 //#include <QtNetwork/private/qtnetworkglobal_p.h>
 #include "sslunsafesocket_openssl_p.h"
 #include <QtCore/qglobal.h>
+#include <QtCore/qatomic.h>
 
 QT_BEGIN_NAMESPACE
 
@@ -78,101 +79,94 @@ QT_BEGIN_NAMESPACE
 
 #if !defined QT_LINKED_OPENSSL
 // **************** Shared declarations ******************
-// ret func(arg)
 
+// cached instead of the address of a symbol missing from the loaded libraries
+static inline void *q_missingOpenSslSymbol()
+{
+    return reinterpret_cast<void *>(quintptr(1));
+}
+
+// Symbols are resolved on their first call (see q_resolveOpenSslSymbol()),
+// only the ones needed to check the loaded library are resolved in advance.
+// The address is kept in an atomic pointer as several threads may race for it.
+// Symbols missing from the loaded libraries are marked as such and not looked up
+// again, their calls fail at once (the warning is only printed on the first one).
+#  define DEFINEFUNC_SYMBOL(ret, func, args) \
+    typedef ret (*_q_PTR_##func) args; \
+    static QBasicAtomicPointer<void> _q_##func = Q_BASIC_ATOMIC_INITIALIZER(nullptr);
+
+#  define DEFINEFUNC_LOAD(func, err) \
+    void *_q_sym = _q_##func.loadAcquire(); \
+    if (Q_UNLIKELY(!_q_sym) && !(_q_sym = q_resolveOpenSslSymbol(#func, &_q_##func))) { \
+        qsslSocketUnresolvedSymbolWarning(#func); \
+        err; \
+    } \
+    if (Q_UNLIKELY(_q_sym == q_missingOpenSslSymbol())) { \
+        err; \
+    }
+
+// ret func(arg)
 #  define DEFINEFUNC(ret, func, arg, a, err, funcret) \
-    typedef ret (*_q_PTR_##func)(arg); \
-    static _q_PTR_##func _q_##func = 0; \
+    DEFINEFUNC_SYMBOL(ret, func, (arg)) \
     ret q_##func(arg) { \
-        if (Q_UNLIKELY(!_q_##func)) { \
-            qsslSocketUnresolvedSymbolWarning(#func); \
-            err; \
-        } \
-        funcret _q_##func(a); \
+        DEFINEFUNC_LOAD(func, err) \
+        funcret reinterpret_cast<_q_PTR_##func>(_q_sym)(a); \
     }
 
 // ret func(arg1, arg2)
 #  define DEFINEFUNC2(ret, func, arg1, a, arg2, b, err, funcret) \
-    typedef ret (*_q_PTR_##func)(arg1, arg2);         \
-    static _q_PTR_##func _q_##func = 0;               \
+    DEFINEFUNC_SYMBOL(ret, func, (arg1, arg2)) \
     ret q_##func(arg1, arg2) { \
-        if (Q_UNLIKELY(!_q_##func)) { \
-            qsslSocketUnresolvedSymbolWarning(#func);\
-            err; \
-        } \
-        funcret _q_##func(a, b); \
+        DEFINEFUNC_LOAD(func, err) \
+        funcret reinterpret_cast<_q_PTR_##func>(_q_sym)(a, b); \
     }
 
 // ret func(arg1, arg2, arg3)
 #  define DEFINEFUNC3(ret, func, arg1, a, arg2, b, arg3, c, err, funcret) \
-    typedef ret (*_q_PTR_##func)(arg1, arg2, arg3);            \
-    static _q_PTR_##func _q_##func = 0;                        \
+    DEFINEFUNC_SYMBOL(ret, func, (arg1, arg2, arg3)) \
     ret q_##func(arg1, arg2, arg3) { \
-        if (Q_UNLIKELY(!_q_##func)) { \
-            qsslSocketUnresolvedSymbolWarning(#func); \
-            err; \
-        } \
-        funcret _q_##func(a, b, c); \
+        DEFINEFUNC_LOAD(func, err) \
+        funcret reinterpret_cast<_q_PTR_##func>(_q_sym)(a, b, c); \
     }
 
 // ret func(arg1, arg2, arg3, arg4)
 #  define DEFINEFUNC4(ret, func, arg1, a, arg2, b, arg3, c, arg4, d, err, funcret) \
-    typedef ret (*_q_PTR_##func)(arg1, arg2, arg3, arg4);               \
-    static _q_PTR_##func _q_##func = 0;                                 \
+    DEFINEFUNC_SYMBOL(ret, func, (arg1, arg2, arg3, arg4)) \
     ret q_##func(arg1, arg2, arg3, arg4) { \
-         if (Q_UNLIKELY(!_q_##func)) { \
-             qsslSocketUnresolvedSymbolWarning(#func); \
-             err; \
-         } \
-         funcret _q_##func(a, b, c, d); \
+        DEFINEFUNC_LOAD(func, err) \
+        funcret reinterpret_cast<_q_PTR_##func>(_q_sym)(a, b, c, d); \
     }
 
 // ret func(arg1, arg2, arg3, arg4, arg5)
 #  define DEFINEFUNC5(ret, func, arg1, a, arg2, b, arg3, c, arg4, d, arg5, e, err, funcret) \
-    typedef ret (*_q_PTR_##func)(arg1, arg2, arg3, arg4, arg5);         \
-    static _q_PTR_##func _q_##func = 0;                                 \
+    DEFINEFUNC_SYMBOL(ret, func, (arg1, arg2, arg3, arg4, arg5)) \
     ret q_##func(arg1, arg2, arg3, arg4, arg5) { \
-        if (Q_UNLIKELY(!_q_##func)) { \
-            qsslSocketUnresolvedSymbolWarning(#func); \
-            err; \
-        } \
-        funcret _q_##func(a, b, c, d, e); \
+        DEFINEFUNC_LOAD(func, err) \
+        funcret reinterpret_cast<_q_PTR_##func>(_q_sym)(a, b, c, d, e); \
     }
 
 // ret func(arg1, arg2, arg3, arg4, arg6)
 #  define DEFINEFUNC6(ret, func, arg1, a, arg2, b, arg3, c, arg4, d, arg5, e, arg6, f, err, funcret) \
-    typedef ret (*_q_PTR_##func)(arg1, arg2, arg3, arg4, arg5, arg6);   \
-    static _q_PTR_##func _q_##func = 0;                                 \
+    DEFINEFUNC_SYMBOL(ret, func, (arg1, arg2, arg3, arg4, arg5, arg6)) \
     ret q_##func(arg1, arg2, arg3, arg4, arg5, arg6) { \
-        if (Q_UNLIKELY(!_q_##func)) { \
-            qsslSocketUnresolvedSymbolWarning(#func); \
-            err; \
-        } \
-        funcret _q_##func(a, b, c, d, e, f); \
+        DEFINEFUNC_LOAD(func, err) \
+        funcret reinterpret_cast<_q_PTR_##func>(_q_sym)(a, b, c, d, e, f); \
     }
 
 // ret func(arg1, arg2, arg3, arg4, arg6, arg7)
 #  define DEFINEFUNC7(ret, func, arg1, a, arg2, b, arg3, c, arg4, d, arg5, e, arg6, f, arg7, g, err, funcret) \
-    typedef ret (*_q_PTR_##func)(arg1, arg2, arg3, arg4, arg5, arg6, arg7);   \
-    static _q_PTR_##func _q_##func = 0;                                       \
+    DEFINEFUNC_SYMBOL(ret, func, (arg1, arg2, arg3, arg4, arg5, arg6, arg7)) \
     ret q_##func(arg1, arg2, arg3, arg4, arg5, arg6, arg7) { \
-        if (Q_UNLIKELY(!_q_##func)) { \
-            qsslSocketUnresolvedSymbolWarning(#func); \
-            err; \
-        } \
-        funcret _q_##func(a, b, c, d, e, f, g); \
+        DEFINEFUNC_LOAD(func, err) \
+        funcret reinterpret_cast<_q_PTR_##func>(_q_sym)(a, b, c, d, e, f, g); \
     }
 
 // ret func(arg1, arg2, arg3, arg4, arg6, arg7, arg8, arg9)
 #  define DEFINEFUNC9(ret, func, arg1, a, arg2, b, arg3, c, arg4, d, arg5, e, arg6, f, arg7, g, arg8, h, arg9, i, err, funcret) \
-    typedef ret (*_q_PTR_##func)(arg1, arg2, arg3, arg4, arg5, arg6, arg7, arg8, arg9);   \
-    static _q_PTR_##func _q_##func = 0;                                                   \
+    DEFINEFUNC_SYMBOL(ret, func, (arg1, arg2, arg3, arg4, arg5, arg6, arg7, arg8, arg9)) \
     ret q_##func(arg1, arg2, arg3, arg4, arg5, arg6, arg7, arg8, arg9) { \
-        if (Q_UNLIKELY(!_q_##func)) { \
-            qsslSocketUnresolvedSymbolWarning(#func); \
-            err; \
-        }   \
-        funcret _q_##func(a, b, c, d, e, f, g, h, i); \
+        DEFINEFUNC_LOAD(func, err) \
+        funcret reinterpret_cast<_q_PTR_##func>(_q_sym)(a, b, c, d, e, f, g, h, i); \
     }
 // **************** Shared declarations ******************
 
@@ -223,6 +217,11 @@ QT_BEGIN_NAMESPACE
 #endif // QT_CONFIG
 
 bool q_resolveOpenSslSymbols();
+#if !defined QT_LINKED_OPENSSL
+// resolves the symbol in the loaded libraries and caches its address, nullptr if it is missing
+// (the address is set to q_missingOpenSslSymbol() then)
+void *q_resolveOpenSslSymbol(const char *name, QBasicAtomicPointer<void> *address);
+#endif
 long q_ASN1_INTEGER_get(ASN1_INTEGER *a);
 int q_ASN1_STRING_length(ASN1_STRING *a);
 int q_ASN1_STRING_to_UTF8(unsigned char **a, ASN1_STRING *b);
@@ -260,6 +259,7 @@ void q_DSA_free(DSA *a);
 X509 *q_d2i_X509(X509 **a, const unsigned char **b, long c);
 char *q_ERR_error_string(unsigned long a, char *b);
 unsigned long q_ERR_get_error();
+unsigned long q_ERR_peek_error();
 EVP_CIPHER_CTX *q_EVP_CIPHER_CTX_new();
 void q_EVP_CIPHER_CTX_free(EVP_CIPHER_CTX *a);
 int q_EVP_CIPHER_CTX_ctrl(EVP_CIPHER_CTX *ctx, int type, int arg, void *ptr);
@@ -287,6 +287,7 @@ EC_KEY *q_EVP_PKEY_get1_EC_KEY(EVP_PKEY *a);
 int q_EVP_PKEY_type(int a);
 Q_AUTOTEST_EXPORT EVP_PKEY *q_EVP_PKEY_new();
 int q_i2d_X509(X509 *a, unsigned char **b);
+int q_i2d_PrivateKey(EVP_PKEY *a, unsigned char **b);
 const char *q_OBJ_nid2sn(int a);
 const char *q_OBJ_nid2ln(int a);
 int q_OBJ_sn2nid(const char *s);
@@ -336,6 +337,11 @@ int q_SSL_accept(SSL *a);
 int q_SSL_clear(SSL *a);
 char *q_SSL_CIPHER_description(const SSL_CIPHER *a, char *b, int c);
 int q_SSL_CIPHER_get_bits(const SSL_CIPHER *a, int *b);
+#if QT_FEATURE_opensslv11 && OPENSSLV11 // QT_CONFIG(opensslv11)
+uint32_t q_SSL_CIPHER_get_id(const SSL_CIPHER *a);
+#else
+unsigned long q_SSL_CIPHER_get_id(const SSL_CIPHER *a);
+#endif
 int q_SSL_connect(SSL *a);
 int q_SSL_CTX_check_private_key(const SSL_CTX *a);
 long q_SSL_CTX_ctrl(SSL_CTX *a, int b, long c, void *d);
@@ -389,6 +395,10 @@ typedef unsigned int (*q_psk_server_callback_t)(SSL *ssl, const char *identity,
 void q_SSL_set_psk_server_callback(SSL *ssl, q_psk_server_callback_t callback);
 int q_SSL_CTX_use_psk_identity_hint(SSL_CTX *ctx, const char *hint);
 #endif // OPENSSL_VERSION_NUMBER >= 0x10001000L && !defined(OPENSSL_NO_PSK)
+typedef void (*q_info_callback_t)(const SSL *ssl, int where, int ret);
+void q_SSL_set_info_callback(SSL *ssl, q_info_callback_t callback);
+typedef void (*q_msg_callback_t)(int write_p, int version, int content_type, const void *buf, size_t len, SSL *ssl, void *arg);
+void q_SSL_set_msg_callback(SSL *ssl, q_msg_callback_t callback);
 int q_SSL_write(SSL *a, const void *b, int c);
 int q_X509_cmp(X509 *a, X509 *b);
 #ifdef SSLEAY_MACROS
@@ -211,20 +211,28 @@ void SslUnsafeSocketPrivate::deinitialize()
 
 bool SslUnsafeSocketPrivate::ensureLibraryLoaded()
 {
-    if (!q_resolveOpenSslSymbols())
-        return false;
-
-    // Check if the library itself needs to be initialized.
     QMutexLocker locker(openssl_locks()->initLock());
 
-    if (!s_libraryLoaded) {
-        s_libraryLoaded = true;
+    // another thread may have completed initialization while this one was waiting,
+    // a nested call from the initializing thread finds it in progress
+    switch (s_libraryLoaded.load()) {
+    case NotInitialized:
+        break;
+    case InitFailed:
+        return false;
+    default:
+        return true;
+    }
+    s_libraryLoaded.store(Initializing);
 
-        // Initialize OpenSSL.
+    // the outcome is final: OpenSSL initialization must not be repeated
+    bool ok = q_resolveOpenSslSymbols();
+    if (ok) {
         q_CRYPTO_set_id_callback(id_function);
         q_CRYPTO_set_locking_callback(locking_function);
-        if (q_SSL_library_init() != 1)
-            return false;
+        ok = (q_SSL_library_init() == 1);
+    }
+    if (ok) {
         q_SSL_load_error_strings();
         q_OpenSSL_add_all_algorithms_safe();
 
@@ -236,63 +244,33 @@ bool SslUnsafeSocketPrivate::ensureLibraryLoaded()
         // Initialize OpenSSL's random seed.
         if (!q_RAND_status()) {
             qWarning("Random number generator not seeded, disabling SSL support");
-            return false;
+            ok = false;
         }
     }
-    return true;
+
+    s_libraryLoaded.storeRelease(ok ? Initialized : InitFailed);
+    return ok;
 }
 
 void SslUnsafeSocketPrivate::ensureCiphersAndCertsLoaded()
 {
     QMutexLocker locker(openssl_locks()->initLock());
-    if (s_loadedCiphersAndCerts)
+
+    // done by another thread, or in progress in this one (loading certificates needs ciphers)
+    if (s_loadedCiphersAndCerts.load() != NotInitialized)
         return;
-    s_loadedCiphersAndCerts = true;
+    s_loadedCiphersAndCerts.store(Initializing);
 
     resetDefaultCiphers();
     resetDefaultEllipticCurves();
 
-#if 1 // QT_CONFIG(library)
-    //load symbols needed to receive certificates from system store
-#if defined(Q_OS_WIN)
-    HINSTANCE hLib = LoadLibraryW(L"Crypt32");
-    if (hLib) {
-        ptrCertOpenSystemStoreW = (PtrCertOpenSystemStoreW)GetProcAddress(hLib, "CertOpenSystemStoreW");
-        ptrCertFindCertificateInStore = (PtrCertFindCertificateInStore)GetProcAddress(hLib, "CertFindCertificateInStore");
-        ptrCertCloseStore = (PtrCertCloseStore)GetProcAddress(hLib, "CertCloseStore");
-        if (!ptrCertOpenSystemStoreW || !ptrCertFindCertificateInStore || !ptrCertCloseStore)
-            qCWarning(lcSsl, "could not resolve symbols in crypt32 library"); // should never happen
-    } else {
-        qCWarning(lcSsl, "could not load crypt32 library"); // should never happen
-    }
-#elif defined(Q_OS_QNX)
-    s_loadRootCertsOnDemand = true;
-#elif defined(Q_OS_UNIX) && !defined(Q_OS_MACOS)
-    // check whether we can enable on-demand root-cert loading (i.e. check whether the sym links are there)
-    QList<QByteArray> dirs = unixRootCertDirectories();
-    QStringList symLinkFilter;
-    symLinkFilter << QLatin1String("[0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f][0-9a-f].[0-9]");
-    for (int a = 0; a < dirs.count(); ++a) {
-        QDirIterator iterator(QLatin1String(dirs.at(a)), symLinkFilter, QDir::Files);
-        if (iterator.hasNext()) {
-            s_loadRootCertsOnDemand = true;
-            break;
-        }
+    // in server-only mode the system certificates are looked for once a socket needs them
+    if (!s_serverOnlyInitialization) {
+        initSystemCaCertificates();
+        s_loadedSystemCaCertificates.storeRelease(Initialized);
     }
-#endif
-#endif // QT_CONFIG(library)
-    // if on-demand loading was not enabled, load the certs now
-    if (!s_loadRootCertsOnDemand)
-        setDefaultCaCertificates(systemCaCertificates());
-#ifdef Q_OS_WIN
-    //Enabled for fetching additional root certs from windows update on windows 6+
-    //This flag is set false by setDefaultCaCertificates() indicating the app uses
-    //its own cert bundle rather than the system one.
-    //Same logic that disables the unix on demand cert loading.
-    //Unlike unix, we do preload the certificates from the cert store.
-    if ((QSysInfo::windowsVersion() & QSysInfo::WV_NT_based) >= QSysInfo::WV_6_0)
-        s_loadRootCertsOnDemand = true;
-#endif
+
+    s_loadedCiphersAndCerts.storeRelease(Initialized);
 }
 
 long SslUnsafeSocketPrivate::sslLibraryVersionNumber()
@@ -65,8 +65,11 @@ class SslUnsafeContext;
 #endif
 
 #include <QtCore/qstringlist.h>
+#include <QtCore/qatomic.h>
+#include <QtCore/qelapsedtimer.h>
 
 #include "sslunsaferingbuffer_p.h"
+#include "sslunsafetranscript_p.h"
 
 #if defined(Q_OS_MAC)
 #include <Security/SecCertificate.h>
@@ -119,6 +122,9 @@ public:
     SslUnsafeConfigurationPrivate configuration;
     QList<SslUnsafeError> sslErrors;
     QSharedPointer<SslUnsafeContext> sslContextPointer;
+    QVector<SslUnsafeHandshakeEvent> handshakeEvents;
+    SslUnsafeTranscript transcript;
+    QElapsedTimer transcriptTimer;
 
     // if set, this hostname is used for certificate validation instead of the hostname
     // that was used for connecting to.
@@ -127,6 +133,10 @@ public:
     bool allowRootCertOnDemandLoading;
 
     static bool s_loadRootCertsOnDemand;
+    // system CA certificates are not loaded until a socket needs them (see initSslContext())
+    static bool s_serverOnlyInitialization;
+    // bytes of handshake transcript kept by sockets starting a handshake, 0 if disabled
+    static QBasicAtomicInt s_handshakeTranscriptSize;
 
     static bool supportsSsl();
     static long sslLibraryVersionNumber();
@@ -139,11 +149,9 @@ public:
     static QList<SslUnsafeCipher> supportedCiphers();
     static void setDefaultCiphers(const QList<SslUnsafeCipher> &ciphers);
     static void setDefaultSupportedCiphers(const QList<SslUnsafeCipher> &ciphers);
-    static void resetDefaultCiphers();
 
     static QVector<SslUnsafeEllipticCurve> supportedEllipticCurves();
     static void setDefaultSupportedEllipticCurves(const QVector<SslUnsafeEllipticCurve> &curves);
-    static void resetDefaultEllipticCurves();
 
     static QList<SslUnsafeCertificate> defaultCaCertificates();
     static QList<SslUnsafeCertificate> systemCaCertificates();
@@ -152,6 +160,7 @@ public:
                                          QRegExp::PatternSyntax syntax);
     static void addDefaultCaCertificate(const SslUnsafeCertificate &cert);
     static void addDefaultCaCertificates(const QList<SslUnsafeCertificate> &certs);
+    static void ensureSystemCaCertificatesLoaded();
     Q_AUTOTEST_EXPORT static bool isMatchingHostname(const SslUnsafeCertificate &cert,
                                                      const QString &peerName);
     Q_AUTOTEST_EXPORT static bool isMatchingHostname(const QString &cn, const QString &hostname);
@@ -271,12 +280,29 @@ public:
 private:
     static bool ensureLibraryLoaded();
     static void ensureCiphersAndCertsLoaded();
+    // called once, by ensureCiphersAndCertsLoaded()
+    static void resetDefaultCiphers();
+    static void resetDefaultEllipticCurves();
+    // called once, by ensureCiphersAndCertsLoaded() or ensureSystemCaCertificatesLoaded()
+    static void initSystemCaCertificates();
+    // sets both lists at once, so no thread can see one of them without the other
+    static void setDefaultCipherLists(const QList<SslUnsafeCipher> &supportedCiphers,
+                                      const QList<SslUnsafeCipher> &defaultCiphers);
 #if defined(Q_OS_ANDROID)
     static QList<QByteArray> fetchSslCertificateData();
 #endif
 
-    static bool s_libraryLoaded;
-    static bool s_loadedCiphersAndCerts;
+    // one-time initialization states, changed under the backend's init mutex only.
+    // Once a state is final, it is read without locking (see supportsSsl() and ensureInitialized())
+    enum InitState {
+        NotInitialized = 0,
+        Initializing,
+        Initialized,
+        InitFailed
+    };
+    static QBasicAtomicInt s_libraryLoaded;
+    static QBasicAtomicInt s_loadedCiphersAndCerts;
+    static QBasicAtomicInt s_loadedSystemCaCertificates;
     // from qabstractsocket_p.h
     QAbstractSocket::SocketError socketError;
 protected:
@@ -0,0 +1,119 @@
+
+#include "sslunsafetranscript_p.h"
+
+#include <string.h>
+
+#ifndef QT_NO_SSL
+
+SslUnsafeTranscript::SslUnsafeTranscript()
+    : m_head(0),
+      m_used(0),
+      m_count(0),
+      m_dropped(0)
+{
+}
+
+void SslUnsafeTranscript::setCapacity(int capacity)
+{
+    if (capacity < int(sizeof(Header)))
+        capacity = 0;
+
+    if (capacity == m_buffer.size()) {
+        clear();
+        return;
+    }
+
+    m_buffer = QByteArray(capacity, Qt::Uninitialized);
+    clear();
+}
+
+void SslUnsafeTranscript::clear()
+{
+    m_head = 0;
+    m_used = 0;
+    m_count = 0;
+    m_dropped = 0;
+}
+
+void SslUnsafeTranscript::append(qint64 timestamp, bool sent, int contentType, int version, const void *data, size_t size)
+{
+    const int capacity = m_buffer.size();
+    if (capacity == 0)
+        return;
+
+    // a record larger than the whole buffer keeps its beginning
+    const int maxStored = capacity - int(sizeof(Header));
+    const int stored = (size > size_t(maxStored)) ? maxStored : int(size);
+    const int total = int(sizeof(Header)) + stored;
+
+    while (m_used + total > capacity) {
+        Header oldest;
+        read(m_head, &oldest, sizeof(oldest));
+        const int oldestTotal = int(sizeof(Header)) + int(oldest.stored);
+        m_head = (m_head + oldestTotal) % capacity;
+        m_used -= oldestTotal;
+        m_count--;
+        m_dropped++;
+    }
+
+    Header header;
+    header.timestamp = timestamp;
+    header.size = quint32(size);
+    header.stored = quint32(stored);
+    header.version = quint16(version);
+    header.contentType = quint8(contentType);
+    header.sent = sent ? 1 : 0;
+
+    const int tail = (m_head + m_used) % capacity;
+    write(tail, &header, sizeof(header));
+    if (stored > 0)
+        write((tail + int(sizeof(header))) % capacity, data, stored);
+    m_used += total;
+    m_count++;
+}
+
+QVector<SslUnsafeHandshakeRecord> SslUnsafeTranscript::records() const
+{
+    QVector<SslUnsafeHandshakeRecord> ret;
+    ret.reserve(m_count);
+
+    const int capacity = m_buffer.size();
+    int pos = m_head;
+    for (int i = 0; i < m_count; i++) {
+        Header header;
+        read(pos, &header, sizeof(header));
+        pos = (pos + int(sizeof(header))) % capacity;
+
+        SslUnsafeHandshakeRecord record;
+        record.timestamp = header.timestamp;
+        record.sent = header.sent;
+        record.contentType = header.contentType;
+        record.version = header.version;
+        record.size = int(header.size);
+        record.data = QByteArray(int(header.stored), Qt::Uninitialized);
+        read(pos, record.data.data(), int(header.stored));
+        pos = (pos + int(header.stored)) % capacity;
+
+        ret << record;
+    }
+
+    return ret;
+}
+
+void SslUnsafeTranscript::write(int pos, const void *src, int size)
+{
+    const int first = qMin(size, m_buffer.size() - pos);
+    char *buffer = m_buffer.data();
+    memcpy(buffer + pos, src, first);
+    memcpy(buffer, static_cast<const char *>(src) + first, size - first);
+}
+
+void SslUnsafeTranscript::read(int pos, void *dst, int size) const
+{
+    const int first = qMin(size, m_buffer.size() - pos);
+    const char *buffer = m_buffer.constData();
+    memcpy(dst, buffer + pos, first);
+    memcpy(static_cast<char *>(dst) + first, buffer, size - first);
+}
+
+#endif // QT_NO_SSL
@@ -0,0 +1,53 @@
+#ifndef SSLUNSAFETRANSCRIPT_P_H
+#define SSLUNSAFETRANSCRIPT_P_H
+
+#include "sslunsafesocket.h"
+
+#include <QtCore/qbytearray.h>
+#include <QtCore/qvector.h>
+
+#ifndef QT_NO_SSL
+
+// Handshake records of one connection, kept in a ring buffer allocated once.
+// When the buffer is full the oldest records are dropped. Appending a record
+// copies it and nothing else, records are only decoded by records().
+class SslUnsafeTranscript
+{
+public:
+    SslUnsafeTranscript();
+
+    // 0 disables recording and releases the buffer
+    void setCapacity(int capacity);
+    int capacity() const { return m_buffer.size(); }
+    bool isEnabled() const { return !m_buffer.isEmpty(); }
+
+    void clear();
+    void append(qint64 timestamp, bool sent, int contentType, int version, const void *data, size_t size);
+
+    int droppedCount() const { return m_dropped; }
+    QVector<SslUnsafeHandshakeRecord> records() const;
+
+private:
+    struct Header {
+        qint64 timestamp;
+        quint32 size;
+        quint32 stored;
+        quint16 version;
+        quint8 contentType;
+        quint8 sent;
+    };
+
+    void write(int pos, const void *src, int size);
+    void read(int pos, void *dst, int size) const;
+
+    QByteArray m_buffer;
+    int m_head;
+    int m_used;
+    int m_count;
+    int m_dropped;
+
+};
+
+#endif // QT_NO_SSL
+
+#endif // SSLUNSAFETRANSCRIPT_P_H
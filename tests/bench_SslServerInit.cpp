@@ -0,0 +1,150 @@
+#include "debug.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QProcess>
+#include <QFile>
+#include <QTcpServer>
+
+#ifdef UNSAFE
+#include "sslunsafesocket.h"
+#include "sslunsafeconfiguration.h"
+#endif
+
+// Compares SSL library initialization of a server with and without the system CA certificates.
+// Each measurement runs in a fresh process (this executable started with the mode as argument),
+// as the initialization happens only once per process.
+
+static const int runsCount = 5;
+
+// resident set size of this process, in kB
+static qint64 residentSetSize()
+{
+    QFile status("/proc/self/status");
+
+    if (!status.open(QIODevice::ReadOnly))
+        return -1;
+
+    const QList<QByteArray> lines = status.readAll().split('\n');
+    for (const QByteArray &line : lines) {
+        if (line.startsWith("VmRSS:"))
+            return line.mid(6).trimmed().split(' ').first().toLongLong();
+    }
+
+    return -1;
+}
+
+#ifdef UNSAFE
+// everything a server needs before it accepts its first client
+static int runChild(bool serverOnly)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    XSslSocket::setServerOnlyInitialization(serverOnly);
+
+    if (!XSslSocket::supportsSsl())
+        return 1;
+
+    XSslConfiguration configuration = XSslConfiguration::defaultConfiguration();
+    configuration.setCiphers(XSslConfiguration::supportedCiphers());
+
+    QTcpServer server;
+    if (!server.listen(QHostAddress::LocalHost))
+        return 1;
+
+    XSslSocket socket;
+    socket.setSslConfiguration(configuration);
+
+    qint64 elapsed = timer.nsecsElapsed() / 1000;
+    qint64 rss = residentSetSize();
+
+    // not measured, makes sure the certificates are still found when needed
+    int caCount = XSslSocket::defaultCaCertificates().size();
+
+    fprintf(stdout, "%lld %lld %d\n", elapsed, rss, caCount);
+    return 0;
+}
+#endif
+
+struct Sample {
+    qint64 elapsed;
+    qint64 rss;
+    int caCount;
+};
+
+static bool runParent(const QString &mode, QList<Sample> *samples)
+{
+    for (int i = 0; i < runsCount; i++) {
+        QProcess child;
+        child.start(QCoreApplication::applicationFilePath(), QStringList() << mode);
+        if (!child.waitForFinished() || (child.exitCode() != 0))
+            return false;
+
+        QList<QByteArray> values = child.readAllStandardOutput().trimmed().split(' ');
+        if (values.size() != 3)
+            return false;
+
+        Sample sample;
+        sample.elapsed = values.at(0).toLongLong();
+        sample.rss = values.at(1).toLongLong();
+        sample.caCount = values.at(2).toInt();
+        *samples << sample;
+    }
+
+    return true;
+}
+
+static Sample best(const QList<Sample> &samples)
+{
+    Sample ret = samples.first();
+
+    for (int i = 1; i < samples.size(); i++) {
+        ret.elapsed = qMin(ret.elapsed, samples.at(i).elapsed);
+        ret.rss = qMin(ret.rss, samples.at(i).rss);
+    }
+
+    return ret;
+}
+
+int main(int argc, char *argv[])
+{
+    // we need QCoreApplication instance to initialize Qt internals
+    QCoreApplication a(argc, argv);
+
+#ifndef UNSAFE
+    WHITE("server-only initialization is only available with the unsafe SSL library, nothing to measure");
+    return 0;
+#else
+    if (a.arguments().size() > 1)
+        return runChild(a.arguments().at(1) == "server-only");
+
+    WHITE("benchmarking SSL library initialization of a server");
+
+    QList<Sample> defaultSamples;
+    QList<Sample> serverOnlySamples;
+    if (!runParent("default", &defaultSamples) || !runParent("server-only", &serverOnlySamples)) {
+        RED("benchmark failed: the measuring process did not complete");
+        return 1;
+    }
+
+    Sample defaultBest = best(defaultSamples);
+    Sample serverOnlyBest = best(serverOnlySamples);
+
+    VERBOSE(QString("best of %1 runs:").arg(runsCount));
+    VERBOSE(QString("  default:     %1 ms, RSS %2 kB").arg(defaultBest.elapsed / 1000.0, 0, 'f', 3).arg(defaultBest.rss));
+    VERBOSE(QString("  server-only: %1 ms, RSS %2 kB").arg(serverOnlyBest.elapsed / 1000.0, 0, 'f', 3).arg(serverOnlyBest.rss));
+    VERBOSE(QString("  saved:       %1 ms, RSS %2 kB")
+            .arg((defaultBest.elapsed - serverOnlyBest.elapsed) / 1000.0, 0, 'f', 3)
+            .arg(defaultBest.rss - serverOnlyBest.rss));
+
+    if (defaultBest.caCount != serverOnlyBest.caCount) {
+        RED(QString("server-only initialization lost CA certificates: %1 found, %2 expected")
+            .arg(serverOnlyBest.caCount).arg(defaultBest.caCount));
+        return 1;
+    }
+
+    GREEN("benchmark of server-only SSL initialization completed");
+    return 0;
+#endif
+}
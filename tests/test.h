@@ -24,7 +24,7 @@ public:
 
         setSslTest();
 
-        if (!sslTest->prepare(testSettings)) {
+        if (!sslTest->ensurePrepared(testSettings)) {
             RED("failed to prepare test " + sslTest->name());
             return;
         }
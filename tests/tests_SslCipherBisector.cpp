@@ -0,0 +1,105 @@
+#include "debug.h"
+#include "sslcipherbisector.h"
+
+#include <QCoreApplication>
+#include <QSet>
+
+#include <cmath>
+
+#ifdef UNSAFE
+#include "sslunsafeconfiguration.h"
+#else
+#include <QSslConfiguration>
+#endif
+
+// Target is SslCipherBisector:
+// the found ciphers are exactly the accepted ones, whatever their pattern,
+// and sparse patterns take far fewer probes than ciphers
+
+static QSet<QString> cipherNames(const QList<XSslCipher> &ciphers)
+{
+    QSet<QString> ret;
+    for (int i = 0; i < ciphers.size(); i++)
+        ret << ciphers.at(i).name();
+    return ret;
+}
+
+// accepts a group if any of its ciphers is accepted, as a client picks one of them
+static bool runPattern(int id, const QString &pattern, const QList<XSslCipher> &ciphers,
+                       const QList<XSslCipher> &accepted, int probesLimit)
+{
+    const QSet<QString> acceptedNames = cipherNames(accepted);
+
+    SslCipherBisector bisector([&](const QList<XSslCipher> &group) {
+        for (int i = 0; i < group.size(); i++) {
+            if (acceptedNames.contains(group.at(i).name()))
+                return SslCipherBisector::Accepted;
+        }
+        return SslCipherBisector::Refused;
+    });
+
+    if (!bisector.run(ciphers)) {
+        RED(QString("autotest #%1 for SslCipherBisector (%2) failed: a probe failed").arg(id).arg(pattern));
+        return false;
+    }
+
+    if (cipherNames(bisector.acceptedCiphers()) != acceptedNames) {
+        RED(QString("autotest #%1 for SslCipherBisector (%2) failed: %3 ciphers found, %4 expected")
+            .arg(id).arg(pattern).arg(bisector.acceptedCiphers().size()).arg(accepted.size()));
+        return false;
+    }
+
+    // at most two probes per level for every accepted cipher, plus the first one
+    int depth = static_cast<int>(std::ceil(std::log2(ciphers.size())));
+    int maxProbes = qMax(accepted.size(), 1) * 2 * depth + 1;
+    if (bisector.probesCount() > maxProbes) {
+        RED(QString("autotest #%1 for SslCipherBisector (%2) failed: %3 probes, at most %4 expected")
+            .arg(id).arg(pattern).arg(bisector.probesCount()).arg(maxProbes));
+        return false;
+    }
+
+    // 0 if there is no limit beyond the one above
+    if ((probesLimit > 0) && (bisector.probesCount() >= probesLimit)) {
+        RED(QString("autotest #%1 for SslCipherBisector (%2) failed: %3 probes for %4 ciphers")
+            .arg(id).arg(pattern).arg(bisector.probesCount()).arg(ciphers.size()));
+        return false;
+    }
+
+    GREEN(QString("autotest #%1 for SslCipherBisector (%2) succeeded: %3 probes for %4 ciphers")
+          .arg(id).arg(pattern).arg(bisector.probesCount()).arg(ciphers.size()));
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    // we need QCoreApplication instance to initialize Qt internals
+    QCoreApplication a(argc, argv);
+
+    const QList<XSslCipher> ciphers = XSslConfiguration::supportedCiphers();
+    if (ciphers.size() < 32) {
+        RED(QString("autotests for SslCipherBisector need at least 32 supported ciphers, %1 found")
+            .arg(ciphers.size()));
+        return 1;
+    }
+
+    QList<XSslCipher> scattered;
+    for (int i = 3; i < ciphers.size(); i += 16)
+        scattered << ciphers.at(i);
+
+    bool ok = true;
+
+    WHITE("launching autotest #1");
+    ok &= runPattern(1, "single", ciphers, QList<XSslCipher>() << ciphers.at(ciphers.size() / 3), ciphers.size() / 2);
+
+    WHITE("launching autotest #2");
+    ok &= runPattern(2, "all", ciphers, ciphers, 0);
+
+    WHITE("launching autotest #3");
+    ok &= runPattern(3, "none", ciphers, QList<XSslCipher>(), ciphers.size() / 2);
+
+    WHITE("launching autotest #4");
+    // every 16th cipher: fewer probes than ciphers, though not below half of them
+    ok &= runPattern(4, "scattered", ciphers, scattered, ciphers.size());
+
+    return ok ? 0 : 1;
+}
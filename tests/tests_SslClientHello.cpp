@@ -0,0 +1,197 @@
+#include "debug.h"
+#include "sslclienthello.h"
+
+#include <QCoreApplication>
+
+// Target is SslClientHello:
+// the first bytes sent by a client are untrusted, they are parsed into
+// a ClientHello (or rejected) whatever the way they are split or forged,
+// and the JA3 fingerprint matches the one of other JA3 implementations
+
+
+static QByteArray uint8(quint32 value)
+{
+    return QByteArray(1, static_cast<char>(value & 0xff));
+}
+
+static QByteArray uint16(quint32 value)
+{
+    return uint8(value >> 8) + uint8(value);
+}
+
+static QByteArray uint24(quint32 value)
+{
+    return uint8(value >> 16) + uint16(value);
+}
+
+static QByteArray extension(quint16 type, const QByteArray &data)
+{
+    return uint16(type) + uint16(data.size()) + data;
+}
+
+static QByteArray list16(const QList<quint16> &values)
+{
+    QByteArray ret;
+    for (int i = 0; i < values.size(); i++)
+        ret += uint16(values.at(i));
+    return ret;
+}
+
+// ClientHello handshake message, 'suitesLength' overrides the length of the cipher suites vector
+static QByteArray clientHello(const QList<quint16> &suites, const QByteArray &extensions,
+                              int suitesLength = -1)
+{
+    QByteArray body;
+
+    body += uint16(0x0303);
+    body += QByteArray(32, 'r'); // random
+    body += uint8(0); // session id
+    body += uint16((suitesLength < 0) ? suites.size() * 2 : suitesLength) + list16(suites);
+    body += uint8(1) + uint8(0); // null compression
+    if (!extensions.isEmpty())
+        body += uint16(extensions.size()) + extensions;
+
+    return uint8(0x01) + uint24(body.size()) + body;
+}
+
+// handshake records carrying 'message' in chunks of at most 'chunkSize' bytes
+static QByteArray records(const QByteArray &message, int chunkSize)
+{
+    QByteArray ret;
+    for (int pos = 0; pos < message.size(); pos += chunkSize) {
+        QByteArray chunk = message.mid(pos, chunkSize);
+        ret += uint8(0x16) + uint16(0x0301) + uint16(chunk.size()) + chunk;
+    }
+    return ret;
+}
+
+// the hello of the JA3 test vector below
+static QByteArray tlsHello()
+{
+    QByteArray extensions;
+    extensions += extension(0x0000, uint16(14) + uint8(0) + uint16(11) + QByteArray("example.com"));
+    extensions += extension(0x000a, uint16(4) + list16(QList<quint16>() << 29 << 23));
+    extensions += extension(0x000b, uint8(1) + uint8(0));
+
+    return clientHello(QList<quint16>() << 0x1301 << 0x1302 << 0xc02b, extensions);
+}
+
+static const QString tlsHelloFingerprint = "771,4865-4866-49195,0-10-11,29-23,0";
+static const QByteArray tlsHelloMd5 = "526cfb56edaf1183f21ff3c5deef718f";
+
+// the same hello with GREASE values in every list
+static QByteArray greaseHello()
+{
+    QByteArray extensions;
+    extensions += extension(0x3a3a, QByteArray());
+    extensions += extension(0x0000, uint16(14) + uint8(0) + uint16(11) + QByteArray("example.com"));
+    extensions += extension(0x000a, uint16(6) + list16(QList<quint16>() << 0x2a2a << 29 << 23));
+    extensions += extension(0x000b, uint8(1) + uint8(0));
+    extensions += extension(0xfafa, uint8(0));
+
+    return clientHello(QList<quint16>() << 0x0a0a << 0x1301 << 0x1302 << 0xc02b, extensions);
+}
+
+// SSLv2-compatible hello offering TLS 1.0 with two cipher specs
+static QByteArray sslV2Hello()
+{
+    QByteArray body;
+
+    body += uint8(0x01);
+    body += uint16(0x0301);
+    body += uint16(6) + uint16(0) + uint16(16);
+    body += uint24(0x000035) + uint24(0x010080);
+    body += QByteArray(16, 'c'); // challenge
+
+    return uint8(0x80 | (body.size() >> 8)) + uint8(body.size()) + body;
+}
+
+struct TestCase
+{
+    QString name;
+    QByteArray data;
+    bool complete;
+    bool valid;
+    // empty if the hello is not valid
+    QString fingerprint;
+};
+
+static bool runCase(int id, const TestCase &testCase)
+{
+    bool complete = SslClientHello::isComplete(testCase.data);
+    SslClientHello hello = SslClientHello::fromData(testCase.data);
+
+    if (complete != testCase.complete) {
+        RED(QString("autotest #%1 for SslClientHello (%2) failed: complete is %3, %4 expected")
+            .arg(id).arg(testCase.name).arg(complete).arg(testCase.complete));
+        return false;
+    }
+
+    if (hello.isValid() != testCase.valid) {
+        RED(QString("autotest #%1 for SslClientHello (%2) failed: valid is %3, %4 expected")
+            .arg(id).arg(testCase.name).arg(hello.isValid()).arg(testCase.valid));
+        return false;
+    }
+
+    if (hello.fingerprintString() != testCase.fingerprint) {
+        RED(QString("autotest #%1 for SslClientHello (%2) failed: fingerprint is \"%3\", \"%4\" expected")
+            .arg(id).arg(testCase.name).arg(hello.fingerprintString()).arg(testCase.fingerprint));
+        return false;
+    }
+
+    GREEN(QString("autotest #%1 for SslClientHello (%2) succeeded").arg(id).arg(testCase.name));
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    // we need QCoreApplication instance to initialize Qt internals
+    QCoreApplication a(argc, argv);
+
+    const QByteArray hello = tlsHello();
+    const QByteArray split = records(hello, 20);
+
+    QByteArray oversizedExtension = tlsHello();
+    // the length of the last extension exceeds the extensions block
+    oversizedExtension[oversizedExtension.size() - 3] = 0x7f;
+
+    const QList<TestCase> cases = QList<TestCase>()
+            << TestCase{"single record", records(hello, hello.size()), true, true, tlsHelloFingerprint}
+            << TestCase{"several records", split, true, true, tlsHelloFingerprint}
+            << TestCase{"several records, last ones missing", records(hello.left(60), 20),
+                        false, false, QString()}
+            << TestCase{"truncated record", records(hello, hello.size()).left(hello.size() / 2),
+                        false, false, QString()}
+            << TestCase{"truncated message", records(hello.left(hello.size() - 10), hello.size()),
+                        false, false, QString()}
+            << TestCase{"oversized cipher suites length",
+                        records(clientHello(QList<quint16>() << 0x1301, QByteArray(), 0xfff0), 0x4000),
+                        true, false, QString()}
+            << TestCase{"oversized extension length", records(oversizedExtension, 0x4000),
+                        true, false, QString()}
+            << TestCase{"SSLv2-compatible", sslV2Hello(), true, true, "769,53-65664,,,"}
+            << TestCase{"SSLv2-compatible, truncated", sslV2Hello().left(20), false, false, QString()}
+            << TestCase{"GREASE values", records(greaseHello(), 0x4000), true, true, tlsHelloFingerprint}
+            << TestCase{"not a handshake", QByteArray("GET / HTTP/1.0\r\n\r\n"), true, false, QString()}
+               ;
+
+    bool ok = true;
+
+    for (int i = 0; i < cases.size(); i++) {
+        WHITE(QString("launching autotest #%1").arg(i + 1));
+        ok &= runCase(i + 1, cases.at(i));
+    }
+
+    int id = cases.size() + 1;
+    WHITE(QString("launching autotest #%1").arg(id));
+    QByteArray md5 = SslClientHello::fromData(records(hello, hello.size())).fingerprint();
+    if (md5 == tlsHelloMd5) {
+        GREEN(QString("autotest #%1 for SslClientHello (JA3 hash) succeeded").arg(id));
+    } else {
+        RED(QString("autotest #%1 for SslClientHello (JA3 hash) failed: %2, %3 expected")
+            .arg(id).arg(QString(md5)).arg(QString(tlsHelloMd5)));
+        ok = false;
+    }
+
+    return ok ? 0 : 1;
+}
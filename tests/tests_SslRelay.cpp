@@ -0,0 +1,145 @@
+#include "test.h"
+#include "ssltests.h"
+
+#include <QCoreApplication>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+#ifdef UNSAFE
+#include "sslunsafesocket.h"
+#else
+#include <QSslSocket>
+#endif
+
+// Target is SslRelay (--forward option):
+// relayed connections last as long as their peers keep them open
+
+static const quint16 upstreamPort = 6666;
+static const quint32 waitDataTimeout = 500;
+
+
+// upstream proxy, sends back everything it receives
+class EchoServer : public QTcpServer
+{
+    Q_OBJECT
+public:
+    EchoServer(QObject *parent = 0) : QTcpServer(parent) {}
+
+public slots:
+    void run()
+    {
+        connect(this, &QTcpServer::newConnection, this, [=]() {
+            QTcpSocket *socket = nextPendingConnection();
+            connect(socket, &QTcpSocket::readyRead, socket, [=]() {
+                socket->write(socket->readAll());
+            });
+            connect(socket, &QTcpSocket::disconnected, socket, &QTcpSocket::deleteLater);
+        });
+        listen(QHostAddress::LocalHost, upstreamPort);
+    }
+
+};
+
+// do not verify peer certificate, keep the relayed connection idle for longer than the wait-data timeout
+// check that data is still relayed afterwards
+class Test01 : public Test
+{
+    Q_OBJECT
+public:
+    int getId() { return 1; }
+
+    void setTestSettings()
+    {
+        testSettings.setUserCN("www.example.com");
+        testSettings.setForwardAddr(QString("127.0.0.1:%1").arg(upstreamPort));
+        testSettings.setWaitDataTimeout(waitDataTimeout);
+    }
+
+    void setSslTest() { targetTest = QString("SslRelay"); sslTest = new SslTest02; }
+
+public slots:
+
+    void run()
+    {
+        XSslSocket *socket = new XSslSocket;
+        QByteArray first = QByteArray("GET / HTTP/1.0\r\n");
+        QByteArray second = QByteArray("\r\n");
+
+        socket->setPeerVerifyMode(XSslSocket::VerifyNone);
+
+        socket->connectToHostEncrypted("localhost", 8443);
+
+        bool ok = false;
+        if (socket->waitForEncrypted()) {
+            socket->write(first);
+            ok = socket->waitForReadyRead() && (socket->readAll() == first);
+
+            // the wait-data timer used to close relayed connections at this point
+            QThread::msleep(3 * waitDataTimeout);
+
+            if (ok && (socket->state() == QAbstractSocket::ConnectedState)) {
+                socket->write(second);
+                ok = socket->waitForReadyRead() && (socket->readAll() == second);
+            } else {
+                ok = false;
+            }
+        }
+        socket->disconnectFromHost();
+
+        if (ok) {
+            printTestSucceeded();
+        } else {
+            printTestFailed();
+        }
+
+        this->deleteLater();
+        QThread::currentThread()->quit();
+    }
+
+};
+
+
+void launchTest(Test *autotest)
+{
+    WHITE(QString("launching autotest #%1").arg(autotest->getId()));
+
+    // we should call it outside of its own thread
+    autotest->prepare();
+
+    QThread *autotestThread = new QThread;
+    autotest->moveToThread(autotestThread);
+    QObject::connect(autotestThread, SIGNAL(started()), autotest, SLOT(run()));
+    QObject::connect(autotestThread, SIGNAL(finished()), autotestThread, SLOT(deleteLater()));
+
+    autotestThread->start();
+
+    autotestThread->wait();
+}
+
+int main(int argc, char *argv[])
+{
+    // we need QCoreApplication instance to initialize Qt internals
+    QCoreApplication a(argc, argv);
+
+    // the main thread is blocked while tests run, the upstream gets its own event loop
+    QThread *upstreamThread = new QThread;
+    EchoServer *upstream = new EchoServer;
+    upstream->moveToThread(upstreamThread);
+    QObject::connect(upstreamThread, SIGNAL(started()), upstream, SLOT(run()));
+    upstreamThread->start();
+
+    QList<Test *> autotests = QList<Test *>()
+            << new Test01
+               ;
+
+    while (autotests.size() > 0) {
+        launchTest(autotests.takeFirst());
+    }
+
+    upstreamThread->quit();
+    upstreamThread->wait();
+
+    return 0; //a.exec();
+}
+
+#include "tests_SslRelay.moc"
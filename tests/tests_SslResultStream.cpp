@@ -0,0 +1,135 @@
+#include "debug.h"
+#include "sslcaudit.h"
+#include "sslresultstream.h"
+#include "ssltests.h"
+
+#include <QCoreApplication>
+#include <QProcess>
+#include <QThread>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#ifdef UNSAFE
+#include "sslunsafesocket.h"
+#else
+#include <QSslSocket>
+#endif
+
+// Target is SslResultStream with "-" as results file:
+// the standard output holds JSON Lines records only, console messages and
+// the summary table go to the standard error.
+// The audit runs in a child process (this executable started with "child" as argument)
+// whose output is checked.
+
+
+// connects once the audit listens, sends some data
+class Client : public QThread
+{
+public:
+    void run() override
+    {
+        QThread::msleep(200);
+
+        XSslSocket socket;
+        socket.setPeerVerifyMode(XSslSocket::VerifyNone);
+        socket.connectToHostEncrypted("localhost", 8443);
+
+        if (socket.waitForEncrypted()) {
+            socket.write("GET / HTTP/1.0\r\n\r\n");
+            socket.waitForBytesWritten();
+            socket.waitForDisconnected();
+        }
+    }
+
+};
+
+static int runChild(QCoreApplication *app)
+{
+    if (!SslResultStream::open("-", SslResultStream::JsonLines))
+        return 1;
+
+    SslUserSettings settings;
+    settings.setUserCN("www.example.com");
+
+    SslTest *test = new SslTest02;
+    if (!test->ensurePrepared(settings))
+        return 1;
+
+    QThread *cauditThread = new QThread;
+    SslCAudit *caudit = new SslCAudit(settings);
+    caudit->setSslTests(QList<SslTest *>() << test);
+    caudit->moveToThread(cauditThread);
+    QObject::connect(cauditThread, SIGNAL(started()), caudit, SLOT(run()));
+    QObject::connect(caudit, &SslCAudit::sslTestsFinished, app, [=]() {
+        caudit->printSummary();
+        SslLog::flush();
+        app->exit();
+    });
+
+    Client client;
+    cauditThread->start();
+    client.start();
+
+    int ret = app->exec();
+
+    client.wait();
+    cauditThread->quit();
+    cauditThread->wait();
+
+    return ret;
+}
+
+int main(int argc, char *argv[])
+{
+    // we need QCoreApplication instance to initialize Qt internals
+    QCoreApplication a(argc, argv);
+
+    if ((a.arguments().size() > 1) && (a.arguments().at(1) == "child"))
+        return runChild(&a);
+
+    WHITE("launching autotest #1");
+
+    QProcess child;
+    child.start(QCoreApplication::applicationFilePath(), QStringList() << "child");
+    if (!child.waitForFinished(30000) || (child.exitCode() != 0)) {
+        child.kill();
+        RED("autotest #1 for SslResultStream failed: the audit did not complete");
+        return 1;
+    }
+
+    const QList<QByteArray> lines = child.readAllStandardOutput().split('\n');
+    const QByteArray console = child.readAllStandardError();
+    int records = 0;
+    bool ok = true;
+
+    for (int i = 0; i < lines.size(); i++) {
+        if (lines.at(i).isEmpty())
+            continue;
+
+        QJsonDocument record = QJsonDocument::fromJson(lines.at(i));
+        if (!record.isObject() || !record.object().contains("result")) {
+            RED("not a record on the standard output: " + QString(lines.at(i)));
+            ok = false;
+            continue;
+        }
+        records++;
+    }
+
+    if (records != 1) {
+        RED(QString("%1 records found, 1 expected").arg(records));
+        ok = false;
+    }
+
+    if (!console.contains("tests results summary table")) {
+        RED("the summary table is not on the standard error");
+        ok = false;
+    }
+
+    if (ok) {
+        GREEN("autotest #1 for SslResultStream succeeded");
+    } else {
+        RED("autotest #1 for SslResultStream failed");
+    }
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,127 @@
+#include "debug.h"
+
+#include <QCoreApplication>
+#include <QThread>
+#include <QSemaphore>
+#include <QTcpServer>
+#include <QEventLoop>
+
+#ifdef UNSAFE
+#include "sslunsafesocket.h"
+#include "sslunsafeconfiguration.h"
+#else
+#include <QSslSocket>
+#include <QSslConfiguration>
+#endif
+
+// Target is one-time SSL library initialization:
+// sockets are started on many threads at once before the library is used by anyone else,
+// each thread has to find it initialized exactly as the main thread sees it afterwards
+
+static const int threadsCount = 64;
+
+class SocketStarter : public QThread
+{
+public:
+    SocketStarter(QSemaphore *ready, QSemaphore *go, quint16 port) :
+        ready(ready),
+        go(go),
+        port(port),
+        supported(false),
+        ciphersCount(0),
+        curvesCount(0),
+        connected(false)
+    {
+    }
+
+    void run() override
+    {
+        ready->release();
+        go->acquire();
+
+        supported = XSslSocket::supportsSsl();
+        ciphersCount = XSslConfiguration::supportedCiphers().size();
+        curvesCount = XSslConfiguration::supportedEllipticCurves().size();
+
+        // the server never answers, the handshake is only started
+        XSslSocket socket;
+        socket.setPeerVerifyMode(XSslSocket::VerifyNone);
+        socket.connectToHostEncrypted("127.0.0.1", port);
+        connected = socket.waitForConnected(5000);
+        socket.abort();
+    }
+
+    QSemaphore *ready;
+    QSemaphore *go;
+    quint16 port;
+    bool supported;
+    int ciphersCount;
+    int curvesCount;
+    bool connected;
+
+};
+
+int main(int argc, char *argv[])
+{
+    // we need QCoreApplication instance to initialize Qt internals
+    QCoreApplication a(argc, argv);
+
+    WHITE("launching autotest #1");
+
+    QTcpServer server;
+    server.setMaxPendingConnections(threadsCount);
+    if (!server.listen(QHostAddress::LocalHost)) {
+        RED("autotest #1 for SSL library initialization failed: can not listen");
+        return 1;
+    }
+
+    QSemaphore ready;
+    QSemaphore go;
+    QList<SocketStarter *> starters;
+    int finished = 0;
+    QEventLoop loop;
+
+    for (int i = 0; i < threadsCount; i++) {
+        SocketStarter *starter = new SocketStarter(&ready, &go, server.serverPort());
+        QObject::connect(starter, &QThread::finished, &loop, [&]() {
+            if (++finished == threadsCount)
+                loop.quit();
+        });
+        starters << starter;
+        starter->start();
+    }
+
+    // release all threads at once
+    ready.acquire(threadsCount);
+    go.release(threadsCount);
+
+    // connections are accepted by the event loop while threads are running
+    loop.exec();
+
+    int ciphersCount = XSslConfiguration::supportedCiphers().size();
+    int curvesCount = XSslConfiguration::supportedEllipticCurves().size();
+    bool ok = XSslSocket::supportsSsl() && (ciphersCount > 0);
+
+    for (int i = 0; i < starters.size(); i++) {
+        const SocketStarter *starter = starters.at(i);
+        if (!starter->supported || !starter->connected
+                || (starter->ciphersCount != ciphersCount)
+                || (starter->curvesCount != curvesCount)) {
+            RED(QString("thread #%1: SSL supported: %2, connected: %3, ciphers: %4 (%5 expected), curves: %6 (%7 expected)")
+                .arg(i).arg(starter->supported).arg(starter->connected)
+                .arg(starter->ciphersCount).arg(ciphersCount)
+                .arg(starter->curvesCount).arg(curvesCount));
+            ok = false;
+        }
+    }
+
+    qDeleteAll(starters);
+
+    if (ok) {
+        GREEN(QString("autotest #1 for SSL library initialization succeeded (%1 threads)").arg(threadsCount));
+    } else {
+        RED("autotest #1 for SSL library initialization failed");
+    }
+
+    return ok ? 0 : 1;
+}
@@ -85,15 +85,7 @@ public slots:
 
         socket->setPeerVerifyMode(XSslSocket::VerifyPeer);
         socket->setProtocol(XSsl::SslV3);
-        QList<XSslCipher> mediumCiphers;
-        QStringList opensslCiphers = ciphers_medium_str.split(":");
-
-        for (int i = 0; i < opensslCiphers.size(); i++) {
-            XSslCipher cipher = XSslCipher(opensslCiphers.at(i));
-
-            if (!cipher.isNull())
-                mediumCiphers << cipher;
-        }
+        QList<XSslCipher> mediumCiphers = sslCiphersOfGrade(SslCiphersMedium);
         if (mediumCiphers.size() == 0) {
             printTestFailed();
             this->deleteLater();
@@ -149,15 +141,7 @@ public slots:
 
         socket->setPeerVerifyMode(XSslSocket::VerifyPeer);
         socket->setProtocol(XSsl::SslV3);
-        QList<XSslCipher> highCiphers;
-        QStringList opensslCiphers = ciphers_high_str.split(":");
-
-        for (int i = 0; i < opensslCiphers.size(); i++) {
-            XSslCipher cipher = XSslCipher(opensslCiphers.at(i));
-
-            if (!cipher.isNull())
-                highCiphers << cipher;
-        }
+        QList<XSslCipher> highCiphers = sslCiphersOfGrade(SslCiphersHigh);
         if (highCiphers.size() == 0) {
             printTestFailed();
             this->deleteLater();
@@ -213,15 +197,7 @@ public slots:
 
         socket->setPeerVerifyMode(XSslSocket::VerifyNone);
         socket->setProtocol(XSsl::SslV3);
-        QList<XSslCipher> mediumCiphers;
-        QStringList opensslCiphers = ciphers_medium_str.split(":");
-
-        for (int i = 0; i < opensslCiphers.size(); i++) {
-            XSslCipher cipher = XSslCipher(opensslCiphers.at(i));
-
-            if (!cipher.isNull())
-                mediumCiphers << cipher;
-        }
+        QList<XSslCipher> mediumCiphers = sslCiphersOfGrade(SslCiphersMedium);
         if (mediumCiphers.size() == 0) {
             printTestFailed();
             this->deleteLater();
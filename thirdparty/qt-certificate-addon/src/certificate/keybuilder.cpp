@@ -45,6 +45,18 @@
 
 QT_BEGIN_NAMESPACE_CERTIFICATE
 
+static uint ec_curve_bits(KeyBuilder::KeyStrength strength)
+{
+    switch(strength) {
+    case KeyBuilder::StrengthHigh:
+        return GNUTLS_CURVE_TO_BITS(GNUTLS_ECC_CURVE_SECP384R1);
+    case KeyBuilder::StrengthUltra:
+        return GNUTLS_CURVE_TO_BITS(GNUTLS_ECC_CURVE_SECP521R1);
+    default:
+        return GNUTLS_CURVE_TO_BITS(GNUTLS_ECC_CURVE_SECP256R1);
+    }
+}
+
 /*!
   \class KeyBuilder
   \brief The KeyBuilder class is a tool for creating QSslKeys.
@@ -58,6 +70,10 @@ QT_BEGIN_NAMESPACE_CERTIFICATE
   will generally be RSA. The various strengths allow you to specify the trade-off
   between the security of the key and the time involved in creating it.
 
+  For elliptic curve keys the strength selects the curve: low and normal strengths
+  give a P-256 key, high gives P-384 and ultra gives P-521. EC keys are much
+  cheaper to create than RSA ones of comparable security.
+
   Note that this method can take a considerable length of time to execute, so in
   gui applications it should be run in a worker thread.
  */
@@ -84,11 +100,30 @@ XSslKey KeyBuilder::generate( XSsl::KeyAlgorithm algo, KeyStrength strength )
         sec = GNUTLS_SEC_PARAM_NORMAL;
     }
 
-    uint bits = gnutls_sec_param_to_pk_bits((algo == XSsl::Rsa) ? GNUTLS_PK_RSA : GNUTLS_PK_DSA, sec);
+    gnutls_pk_algorithm_t pk;
+    uint bits;
+    switch(algo) {
+    case XSsl::Rsa:
+        pk = GNUTLS_PK_RSA;
+        bits = gnutls_sec_param_to_pk_bits(pk, sec);
+        break;
+    case XSsl::Dsa:
+        pk = GNUTLS_PK_DSA;
+        bits = gnutls_sec_param_to_pk_bits(pk, sec);
+        break;
+    case XSsl::Ec:
+        pk = GNUTLS_PK_EC;
+        bits = ec_curve_bits(strength);
+        break;
+    default:
+        qWarning("Unhandled algorithm %d passed to generate", uint(algo));
+        return XSslKey();
+    }
+
     gnutls_x509_privkey_t key;
     gnutls_x509_privkey_init(&key);
 
-    int errnumber = gnutls_x509_privkey_generate(key, (algo == XSsl::Rsa) ? GNUTLS_PK_RSA : GNUTLS_PK_DSA, bits, 0u);
+    int errnumber = gnutls_x509_privkey_generate(key, pk, bits, 0u);
     if (GNUTLS_E_SUCCESS != errnumber) {
         qWarning("Failed to generate key %s", gnutls_strerror(errnumber));
         gnutls_x509_privkey_deinit(key);
@@ -96,9 +131,9 @@ XSslKey KeyBuilder::generate( XSsl::KeyAlgorithm algo, KeyStrength strength )
     }
 
     XSslKey qkey = key_to_qsslkey(key, algo, &errnumber);
+    gnutls_x509_privkey_deinit(key);
     if (GNUTLS_E_SUCCESS != errnumber) {
         qWarning("Failed to convert key to bytearray %s", gnutls_strerror(errnumber));
-        gnutls_x509_privkey_deinit(key);
         return XSslKey();
     }
 
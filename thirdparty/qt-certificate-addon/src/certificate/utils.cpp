@@ -56,13 +56,10 @@ using namespace Certificate;
 
 void ensure_gnutls_init()
 {
-    static bool done = false;
-
-    // TODO: protect with a mutex
-    if (!done) {
-        gnutls_global_init();
-        done = true;
-    }
+    // certificates are generated from several threads, initialization of
+    // function-local statics is thread-safe
+    static const int done = gnutls_global_init();
+    Q_UNUSED(done)
 }
 
 QByteArray entrytype_to_oid(Certificate::EntryType type)